@@ -1,5 +1,7 @@
 #include "Auxilaries.h"
 
+#include <algorithm>
+
 namespace Nardi
 {
 
@@ -25,6 +27,91 @@ std::string Coord::AsStr() const
 {   return "(" + std::to_string(row) + ", " + std::to_string(col) + ")";   }
 
 
+///////////// ZobristKeySet /////////////
+
+bool ZobristKeySet::insert(ZobristKey key)
+{
+    if(key == 0)
+    {
+        bool fresh = !_hasZero;
+        _hasZero = true;
+        return fresh;
+    }
+    if(2 * (_size + 1) > _slots.size())   // keep load <= 1/2
+        grow();
+
+    std::size_t mask = _slots.size() - 1;
+    for(std::size_t i = key & mask; ; i = (i + 1) & mask)
+    {
+        if(_slots[i] == key)
+            return false;
+        if(_slots[i] == 0)
+        {
+            _slots[i] = key;
+            ++_size;
+            return true;
+        }
+    }
+}
+
+bool ZobristKeySet::contains(ZobristKey key) const
+{
+    if(key == 0)
+        return _hasZero;
+    if(_slots.empty())
+        return false;
+
+    std::size_t mask = _slots.size() - 1;
+    for(std::size_t i = key & mask; _slots[i] != 0; i = (i + 1) & mask)
+        if(_slots[i] == key)
+            return true;
+    return false;
+}
+
+void ZobristKeySet::clear()
+{
+    if(_size)
+        std::fill(_slots.begin(), _slots.end(), 0);
+    _size = 0;
+    _hasZero = false;
+}
+
+void ZobristKeySet::grow()
+{
+    std::vector<ZobristKey> old(_slots.empty() ? 64 : 2 * _slots.size(), 0);
+    old.swap(_slots);
+
+    std::size_t mask = _slots.size() - 1;
+    for(ZobristKey key : old)
+        if(key != 0)
+        {
+            std::size_t i = key & mask;
+            while(_slots[i] != 0)
+                i = (i + 1) & mask;
+            _slots[i] = key;
+        }
+}
+
+
+///////////// PackedSeq /////////////
+
+MoveSequence PackedSeq::Unpack(bool player, const DieType& dice) const
+{
+    MoveSequence seq;
+    for(int k = 0; k < len; ++k)
+        seq.push_back(PackedMove(player, PathIdx(k), DieIdx(k), dice[DieIdx(k)]));
+    return seq;
+}
+
+PackedSeq PackedSeq::Pack(const MoveSequence& seq)
+{
+    PackedSeq packed;
+    for(PackedMove m : seq)
+        packed.Push(m.PathIdx(), m.DieIdx());
+    return packed;
+}
+
+
 ///////////// Command /////////////
 
 Command::Command(Actions a) : action(a) {}
@@ -2,8 +2,11 @@
 
 #include <iostream>
 #include <array>
+#include <cassert>
 #include <variant>
+#include <stdexcept>
 #include <string>
+#include <vector>
 #include <cstdint> // Required for int8_t
 
 
@@ -18,6 +21,8 @@ constexpr int ROWS = 2;
 constexpr int COLS = 12;
 constexpr int PIECES_PER_PLAYER = 15;
 
+constexpr uint32_t PATH_MASK = (1u << (ROWS * COLS)) - 1;   // one bit per point of a 24-point path
+
 ////////////////////////////////////////////////////////////////////////////////
 // Useful Aliases
 ////////////////////////////////////////////////////////////////////////////////
@@ -33,21 +38,107 @@ inline void hash_combine(std::size_t& seed, const T& v)
     seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
-// Hash function for BoardConfig
+////////////////////////////////////////////////////////////////////////////////
+// Zobrist hashing
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+One random 64-bit word per (square, signed checker count) pair, plus one for the
+side to move. A position's key is the XOR of the words for its occupied squares,
+so a sub-move only touches the two squares it changes: Board keeps its key up to
+date in Move/Remove/Undo* instead of rehashing all 24 squares on every lookup.
+Count 0 maps to 0 so empty squares contribute nothing.
+*/
+using ZobristKey = uint64_t;
+
+namespace Zobrist
+{
+
+constexpr int N_COUNTS = 2 * PIECES_PER_PLAYER + 1;  // signed counts -15..15
+
+struct Tables
+{
+    std::array<std::array<ZobristKey, N_COUNTS>, ROWS * COLS> cell{};
+    ZobristKey side = 0;
+};
+
+constexpr ZobristKey SplitMix64(ZobristKey& state)
+{
+    ZobristKey z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+constexpr Tables MakeTables()
+{
+    Tables t;
+    ZobristKey state = 0x4e61726469ull;   // fixed seed: keys are stable across runs
+    for(auto& square : t.cell)
+        for(int n = 0; n < N_COUNTS; ++n)
+            square[n] = (n == PIECES_PER_PLAYER) ? 0 : SplitMix64(state);
+    t.side = SplitMix64(state);
+    return t;
+}
+
+inline constexpr Tables TABLES = MakeTables();
+
+inline ZobristKey Cell(int r, int c, int8_t n)
+{   return TABLES.cell[r * COLS + c][n + PIECES_PER_PLAYER];   }
+
+inline ZobristKey Side(bool p_idx)
+{   return p_idx ? TABLES.side : 0;   }
+
+// Key of a bare board (no side-to-move term).
+inline ZobristKey Of(const BoardConfig& b)
+{
+    ZobristKey key = 0;
+    for(int r = 0; r < ROWS; ++r)
+        for(int c = 0; c < COLS; ++c)
+            key ^= Cell(r, c, b[r][c]);
+    return key;
+}
+
+}   // namespace Zobrist
+
+// Hash function for BoardConfig: the Zobrist key of the board.
 struct BoardConfigHash 
 {
     std::size_t operator()(const BoardConfig& key) const
     {
-        std::size_t seed = 0;
-        for(const auto& inner_container : key)
-        {
-            for(const auto& num : inner_container)
-                hash_combine(seed, num);
-        }
-        return seed;
+        return static_cast<std::size_t>(Zobrist::Of(key));
+    }
+};
+
+// For containers keyed by an already-computed Zobrist key (e.g. Board::Key()):
+// the key is uniformly distributed, so it is its own hash.
+struct ZobristKeyHash
+{
+    std::size_t operator()(ZobristKey key) const
+    {
+        return static_cast<std::size_t>(key);
     }
 };
 
+// Open-addressing set of Zobrist keys for per-search scratch (visited / emitted
+// positions). Unlike unordered_set it allocates nothing per insert, and clear()
+// keeps the table, so a reused set stops allocating once it has grown.
+class ZobristKeySet
+{
+    public:
+        bool insert(ZobristKey key);            // true if key was not yet present
+        bool contains(ZobristKey key) const;
+        void clear();
+        std::size_t size() const { return _size + _hasZero; }
+
+    private:
+        std::vector<ZobristKey> _slots;         // power-of-two size, 0 = empty
+        std::size_t _size = 0;                  // non-zero keys stored
+        bool _hasZero = false;                  // key 0 kept out of band
+
+        void grow();
+};
+
 
 ////////////////////////////////////////////////////////////////////////////////
 // Meaningful bools for colors and dice
@@ -103,8 +194,8 @@ enum class Actions
 
 struct Coord
 {
-    Coord(int r, int c) : row(r), col(c) {}
-    Coord() : row(-1), col(-1) {} // initialize out of bounds to force explicit assignment before use
+    constexpr Coord(int r, int c) : row(r), col(c) {}
+    constexpr Coord() : row(-1), col(-1) {} // initialize out of bounds to force explicit assignment before use
 
     bool operator==(const Coord& rhs) const;
     bool OutOfBounds() const;
@@ -127,6 +218,62 @@ struct CoordHash
     }
 };
 
+////////////////////////////////////////////////////////////////////////////////
+// Path tables
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+Each player's checkers travel one fixed 24-point path: their own row from the
+head (index 0), then the other row up to the last point (index 23); the last 6
+points are home. These tables map squares to path indices and back for both
+players, and give the index reached after a step, so move arithmetic is a
+lookup instead of row-wrap branching. OFF marks a step past the last point.
+*/
+namespace Path
+{
+
+constexpr int LEN  = ROWS * COLS;
+constexpr int HOME = LEN - 6;   // first home point
+constexpr int OFF  = LEN;
+
+struct Tables
+{
+    std::array<std::array<int8_t, LEN>, 2> idx{};       // [player][row * COLS + col] -> path index
+    std::array<std::array<Coord, LEN>, 2>  coord{};     // [player][path index] -> square
+    std::array<std::array<int8_t, LEN + 1>, LEN> after{};  // [path index][steps] -> path index or OFF
+};
+
+constexpr Tables MakeTables()
+{
+    Tables t;
+    for(int p = 0; p < 2; ++p)
+        for(int i = 0; i < LEN; ++i)
+        {
+            Coord c(i < COLS ? p : !p, i % COLS);
+            t.coord[p][i] = c;
+            t.idx[p][c.row * COLS + c.col] = static_cast<int8_t>(i);
+        }
+    for(int i = 0; i < LEN; ++i)
+        for(int d = 0; d <= LEN; ++d)
+            t.after[i][d] = static_cast<int8_t>(i + d < LEN ? i + d : OFF);
+    return t;
+}
+
+inline constexpr Tables TABLES = MakeTables();
+
+// c must be in bounds
+inline int Idx(bool player, const Coord& c)
+{   return TABLES.idx[player][c.row * COLS + c.col];   }
+
+inline const Coord& CoordOf(bool player, int i)
+{   return TABLES.coord[player][i];   }
+
+// 0 <= d <= LEN
+inline int After(int i, int d)
+{   return TABLES.after[i][d];   }
+
+}   // namespace Path
+
 struct StartAndDice
 { 
     StartAndDice(const Coord& f, bool d) : _from(f), _diceIdx(d) {}
@@ -134,7 +281,92 @@ struct StartAndDice
     bool _diceIdx; 
 };
 
-using MoveSequence = std::vector<StartAndDice>;
+// One sub-move in 16 bits: start path index (bits 0-4), die index (5), bear-off
+// (6), mover (7) and die value (8-10). Carrying the mover and the die value makes
+// it self-describing, so it decodes to squares without the game that made it.
+class PackedMove
+{
+    public:
+        PackedMove() = default;
+        PackedMove(bool player, int path_idx, bool die_idx, int die_val) :
+            _bits(static_cast<uint16_t>(path_idx | die_idx << 5 | (path_idx + die_val >= Path::LEN) << 6 |
+                                        player << 7 | die_val << 8)) {}
+        PackedMove(bool player, const Coord& from, bool die_idx, int die_val) :
+            PackedMove(player, Path::Idx(player, from), die_idx, die_val) {}
+
+        int  PathIdx() const  { return _bits & 0x1F; }
+        bool DieIdx() const   { return (_bits >> 5) & 1u; }
+        bool BearOff() const  { return (_bits >> 6) & 1u; }
+        bool Player() const   { return (_bits >> 7) & 1u; }
+        int  DieValue() const { return (_bits >> 8) & 0x7; }
+        uint16_t Bits() const { return _bits; }
+
+        const Coord& From() const { return Path::CoordOf(Player(), PathIdx()); }
+        Coord To() const    // out of bounds for a bear-off
+        {   return BearOff() ? Coord{} : Path::CoordOf(Player(), PathIdx() + DieValue());   }
+
+        bool operator==(const PackedMove& rhs) const { return _bits == rhs._bits; }
+
+    private:
+        uint16_t _bits = 0;
+};
+static_assert(sizeof(PackedMove) == 2);
+
+// A turn's sub-moves, stored inline: a turn is at most 4 sub-moves, so copying
+// one into history or a legal-turn map never allocates.
+class MoveSequence
+{
+    public:
+        static constexpr int CAPACITY = 4;
+
+        void push_back(PackedMove m)
+        {
+            assert(_len < CAPACITY);
+            _moves[_len++] = m;
+        }
+        void pop_back()              { --_len; }
+        void clear()                 { _len = 0; }
+
+        std::size_t size() const { return _len; }
+        bool empty() const       { return _len == 0; }
+
+        PackedMove operator[](std::size_t k) const { return _moves[k]; }
+        PackedMove at(std::size_t k) const
+        {
+            if(k >= _len)
+                throw std::out_of_range("MoveSequence::at");
+            return _moves[k];
+        }
+        PackedMove back() const { return _moves[_len - 1]; }
+
+        const PackedMove* begin() const { return _moves.data(); }
+        const PackedMove* end() const   { return _moves.data() + _len; }
+
+    private:
+        std::array<PackedMove, CAPACITY> _moves{};
+        uint8_t _len = 0;
+};
+
+// A turn packed into 32 bits for movegen and search: sub-move k is byte k,
+// (start path index << 1) | die index, indices in the mover's own path order.
+// A turn is at most 4 sub-moves, so this needs no allocation.
+struct PackedSeq
+{
+    uint32_t moves = 0;
+    uint8_t len = 0;
+
+    void Push(int path_idx, bool die_idx)
+    {   moves |= uint32_t((path_idx << 1) | die_idx) << (8 * len++);   }
+    void Pop()
+    {   moves &= ~(0xFFu << (8 * --len));   }
+
+    int  PathIdx(int k) const { return (moves >> (8 * k + 1)) & 0x1F; }
+    bool DieIdx(int k) const  { return (moves >> (8 * k)) & 1u; }
+    StartAndDice At(bool player, int k) const { return {Path::CoordOf(player, PathIdx(k)), DieIdx(k)}; }
+
+    MoveSequence Unpack(bool player, const DieType& dice) const;
+    static PackedSeq Pack(const MoveSequence& seq);
+};
 
 
 struct Command // considering making this std::variant or something... 
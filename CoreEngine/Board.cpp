@@ -1,15 +1,21 @@
 #include "Board.h"
 
+#include <algorithm>
+#include <bit>
+
 using namespace Nardi;
 
 ///////////// Constructor /////////////
 
 Board::Board() :      data {{   { PIECES_PER_PLAYER, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, 
                                 {-PIECES_PER_PLAYER, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0} }},
+                                zobrist(Zobrist::Of(data)),
                                 pieces_per_player{ {PIECES_PER_PLAYER, PIECES_PER_PLAYER} },
                                 player_idx(0), player_sign(BoolToSign(player_idx)), head_used(false),
                                 reached_enemy_home{0, 0}, pieces_left{PIECES_PER_PLAYER, PIECES_PER_PLAYER}
-{}
+{
+    CalcDerived();
+}
 
 Board::Board(const BoardConfig& d) : player_idx(0), player_sign(BoolToSign(player_idx)), head_used(false)
 {
@@ -18,16 +24,55 @@ Board::Board(const BoardConfig& d) : player_idx(0), player_sign(BoolToSign(playe
 
 ///////////// Updates and Actions /////////////
 
+void Board::SetPosition(const BoardConfig& b, bool p_idx, bool head)
+{
+    player_idx = p_idx;
+    player_sign = BoolToSign(player_idx);
+    head_used = head;
+    SetData(b);
+}
+
+void Board::AddToSquare(const Coord& s, int8_t delta)
+{
+    int8_t& square = data.at(s.row).at(s.col);
+    int8_t before = square;
+    zobrist ^= Zobrist::Cell(s.row, s.col, square);
+    square += delta;
+    zobrist ^= Zobrist::Cell(s.row, s.col, square);
+    UpdateDerived(s, before);
+}
+
+void Board::UpdateDerived(const Coord& s, int8_t before)
+{
+    int8_t n = data[s.row][s.col];
+    for(bool p : {white, black})
+    {
+        int i = Path::Idx(p, s);
+        uint32_t bit = 1u << i;
+        int own = std::max(p ? -n : int(n), 0);
+        int was = std::max(p ? -before : int(before), 0);
+
+        occ_bits[p]   = (own >= 1) ? (occ_bits[p] | bit)   : (occ_bits[p] & ~bit);
+        stack_bits[p] = (own >= 2) ? (stack_bits[p] | bit) : (stack_bits[p] & ~bit);
+
+        occ_planes[p][0][i] = (own >= 1);
+        occ_planes[p][1][i] = (own >= 2);
+        occ_planes[p][2][i] = (own >= 2) ? own - 2 : 0;
+
+        pip_counts[p] += (own - was) * (Path::LEN - i);     // steps to bear off, i.e. one past the last point
+    }
+}
+
 void Board::Move(const Coord& start, const Coord& end)
 {
-    data.at(start.row).at(start.col)  -= player_sign;
-    data.at(end.row).at(end.col)      += player_sign;
+    AddToSquare(start, -player_sign);
+    AddToSquare(end, player_sign);
     OnMove(start, end);
 }
 
 void Board::OnMove(const Coord& start, const Coord& end)
 {
-    if(end.row != player_idx && end.col >= 6 && (start.col < 6 || start.row != end.row) )  // moved to home from outside
+    if(Path::Idx(player_idx, end) >= Path::HOME && Path::Idx(player_idx, start) < Path::HOME)  // moved to home from outside
         ++reached_enemy_home[player_idx];
 
     if(!head_used && IsPlayerHead(start))
@@ -36,14 +81,14 @@ void Board::OnMove(const Coord& start, const Coord& end)
 
 void Board::UndoMove(const Coord& start, const Coord& end)
 {
-    data.at(start.row).at(start.col)  += player_sign;
-    data.at(end.row).at(end.col)      -= player_sign;
+    AddToSquare(start, player_sign);
+    AddToSquare(end, -player_sign);
     OnUndoMove(start, end);
 }
 
 void Board::OnUndoMove(const Coord& start, const Coord& end)
 {
-    if(end.row != player_idx && end.col >= 6 && (start.col < 6 || start.row != end.row) )  // moved to home from outside
+    if(Path::Idx(player_idx, end) >= Path::HOME && Path::Idx(player_idx, start) < Path::HOME)  // moved to home from outside
         --reached_enemy_home[player_idx];
 
     if(IsPlayerHead(start))
@@ -52,23 +97,21 @@ void Board::OnUndoMove(const Coord& start, const Coord& end)
 
 void Board::Remove(const Coord& to_remove)
 {
-    data.at(to_remove.row).at(to_remove.col) -= player_sign;
+    AddToSquare(to_remove, -player_sign);
     --pieces_left.at(player_idx);
 }
 
 void Board::UndoRemove(const Coord& to_remove)
 {
-    data.at(to_remove.row).at(to_remove.col) += player_sign;
+    AddToSquare(to_remove, player_sign);
     ++pieces_left.at(player_idx);
 }
 
 int Board::MaxNumOcc() const
 {
-    int max_num_occ = 6;
-    while(max_num_occ > 0 && player_sign * at(!player_idx, COLS - max_num_occ) <= 0 )   // slot empty or enemy
-        --max_num_occ;
-        
-    return max_num_occ;
+    // home is the last 6 points of the path; distance from the furthest occupied one to off
+    uint32_t home = occ_bits[player_idx] >> Path::HOME;
+    return home ? 6 - std::countr_zero(home) : 0;
 }
 
 ///////////// Legality /////////////
@@ -77,7 +120,7 @@ status_codes Board::ValidStart(const Coord& start) const
 {
     if(start.OutOfBounds())
         return status_codes::OUT_OF_BOUNDS;
-    else if ( player_sign * at(start) <= 0)
+    else if ( !(occ_bits[player_idx] >> Path::Idx(player_idx, start) & 1u) )
         return status_codes::START_EMPTY_OR_ENEMY;
     else if ( HeadReuseIssue(start) ) 
         return status_codes::HEAD_PLAYED_ALREADY;
@@ -94,7 +137,7 @@ status_codes Board::WellDefinedEnd(const Coord& start, const Coord& end, bool pl
 {
     if( end.OutOfBounds() )
         return status_codes::OUT_OF_BOUNDS;
-    else if ( BoolToSign(player) * at(end) < 0)   // destination occupied by player's opponent
+    else if ( occ_bits[!player] >> Path::Idx(!player, end) & 1u )   // destination occupied by player's opponent
         return status_codes::DEST_ENEMY;
     else if(start.row == end.row )
     {
@@ -118,24 +161,20 @@ bool Board::Bad_RowChangeTo(bool er, bool player) const
 
 ///////////// Calculations /////////////
 
+uint32_t Board::RotatePath(uint32_t bits)
+{   return ((bits >> COLS) | (bits << COLS)) & PATH_MASK;   }
+
 Coord Board::CoordAfterDistance(const Coord& start, int d, bool player) const
 {
-    int ec = start.col + d;
-    if(ec >= 0 && ec < COLS) // no row changing
-        return {start.row, ec};
-    else
-    {
-        bool er = !start.row;
-        if( (d > 0 && Bad_RowChangeTo(er, player)) || (d < 0 && Bad_RowChangeTo(start.row, player)) )   
-            return {start.row, ec};    // moved forward past end or backwards before beginning of board, return original out of bounds value
-        
-        else if(ec < 0)
-            ec = COLS + ec;
-        else // ec > COLS
-            ec -= COLS;
-
-        return {!start.row, ec};
-    }
+    if(start.OutOfBounds())
+        return {};
+
+    int i = Path::Idx(player, start);
+    int end = (d >= 0) ? Path::After(i, d) : i + d;
+    if(end < 0 || end == Path::OFF)  // moved forward past end or backwards before beginning of board
+        return {};
+
+    return Path::CoordOf(player, end);
 }
 
 Coord Board::CoordAfterDistance(const Coord& start, int d) const
@@ -150,12 +189,7 @@ int Board::GetDistance(const Coord& start, const Coord& end) const
 
 int Board::GetDistance(const Coord& start, const Coord& end, bool player) const
 {
-    if(start.row == end.row)
-        return end.col - start.col;
-    else if(end.row != player)  // row change forward
-        return COLS - start.col + end.col;   
-    else                            // row change backward
-        return -(COLS - end.col + start.col);
+    return Path::Idx(player, end) - Path::Idx(player, start);
 }
 
 unsigned Board::MovablePieces(const Coord& start) const
@@ -182,6 +216,7 @@ bool Board::operator== (const Board& other) const
 void Board::SetData(const BoardConfig& b)
 {
     data = b;
+    zobrist = Zobrist::Of(data) ^ Zobrist::Side(player_idx);
     CalcPiecesLeftandReached();
     // Nardi always has 15 checkers per side; any not on the board have been borne
     // off. Keep the per-player total at the invariant (NOT the on-board count) so
@@ -189,33 +224,37 @@ void Board::SetData(const BoardConfig& b)
     // correct for set-up positions, matching a played game. CalcPiecesLeftand-
     // Reached already credited the borne-off checkers to reached_enemy_home.
     pieces_per_player = {PIECES_PER_PLAYER, PIECES_PER_PLAYER};
+    CalcDerived();
+}
+
+void Board::CalcDerived()
+{
+    occ_bits = {0, 0};
+    stack_bits = {0, 0};
+    occ_planes = {};
+    pip_counts = {0, 0};
+    for(int r = 0; r < ROWS; ++r)
+        for(int c = 0; c < COLS; ++c)
+            UpdateDerived({r, c}, 0);
 }
 
 void Board::CalcPiecesLeftandReached()
 {
-    Coord starts [2] = { {0, 0}, {1, 0} };
     pieces_left = {0, 0};
     reached_enemy_home = {0, 0};
-    
-    for (; starts[0].col < 6; 
-                starts[0] = CoordAfterDistance(starts[0], 1),
-                starts[1] = CoordAfterDistance(starts[1], 1)    )
-    {
-        pieces_left[at(starts[0]) < 0] += abs(at(starts[0]));   // no-op if 0
-        pieces_left[at(starts[1]) < 0] += abs(at(starts[1]));
-    }
-    for (;  starts[0].row == 0 && starts[0].col < COLS;
-                    starts[0] = CoordAfterDistance(starts[0], 1),
-                    starts[1] = CoordAfterDistance(starts[1], 1)    )    
-    {
-        if(at(starts[0]) < 0)   // black piece at end of white's row - home
-            reached_enemy_home[1] += abs(at(starts[0]));
-        if(at(starts[1]) > 0)   // white piece at end of black's row - home
-            reached_enemy_home[0] += abs(at(starts[1]));
 
-        pieces_left[at(starts[0]) < 0] += abs(at(starts[0]));   // no-op if 0
-        pieces_left[at(starts[1]) < 0] += abs(at(starts[1]));
-    }
+    for(int r = 0; r < ROWS; ++r)
+        for(int c = 0; c < COLS; ++c)
+        {
+            int8_t n = data[r][c];
+            if(n == 0)
+                continue;
+
+            bool p = (n < 0);
+            pieces_left[p] += abs(n);
+            if(Path::Idx(p, {r, c}) >= Path::HOME)
+                reached_enemy_home[p] += abs(n);
+        }
 
     // Borne-off checkers (15 minus those on the board) have already reached home,
     // so credit them to reached_enemy_home. This matches played-game bookkeeping
@@ -244,6 +283,18 @@ const BoardConfig& Board::View() const
     return data;
 }
 
+ZobristKey Board::Key() const
+{   return zobrist;   }
+
+uint32_t Board::OccBits(bool player) const
+{   return occ_bits[player];   }
+
+uint32_t Board::StackBits(bool player) const
+{   return stack_bits[player];   }
+
+uint32_t Board::EnemyBits(bool player) const
+{   return RotatePath(occ_bits[!player]);   }
+
 bool Board::PlayerIdx() const
 {   return player_idx;   }
 
@@ -272,6 +323,7 @@ void Board::SwitchPlayer()
 {
     player_idx = !player_idx;
     player_sign = BoolToSign(player_idx);
+    zobrist ^= Zobrist::TABLES.side;
     head_used = false;
 }
 
@@ -293,75 +345,73 @@ void Board::Features::SwapPerspective() {
     std::swap(opp, player);
 }
 
+// Re-index occ planes from one player's path order into the other's: point i
+// on one path is point (i + COLS) % 24 on the other.
+static void RotatePlanes(Board::Features::OccPlanes& planes)
+{
+    for(auto& plane : planes)
+        std::rotate(plane.begin(), plane.begin() + COLS, plane.end());
+}
+
+Board::Features Board::Features::Flipped() const
+{
+    Features flipped;
+    flipped.raw_data = raw_data;
+    flipped.player = opp;
+    flipped.opp = player;
+    RotatePlanes(flipped.player.occ);
+    RotatePlanes(flipped.opp.occ);
+    return flipped;
+}
+
 const Board::Features Board::ExtractFeatures() const
+{
+    return ExtractFeatures(player_idx);
+}
+
+const Board::Features Board::ExtractFeatures(bool p_idx) const
 {
     Features features;
     features.raw_data = data;
 
-    // important note: both occ arrays 0-init
+    // both sides' planes are indexed along p_idx's path
     Features::PlayerBoardInfo& player  = features.player;
     Features::PlayerBoardInfo& opp     = features.opp;
 
-    player.pip_count = 0;
-    opp.pip_count = 0;
-
-    std::array<int, 2> sq_oc_each{};
-
-    // fill occ arrays, sq_occ, pip counts, and unblocked dice options for both players 
-    Coord head(player_idx, 0); // player head
-    for(int i = 0; i < ROWS*COLS; ++i)
-    {
-        Coord coord = CoordAfterDistance(head, i);
-        int occupancy = at(coord) * player_sign;
-        int n_pieces = abs(occupancy);
-
-        bool friendly = (occupancy >= 0);
-        std::array<std::array<uint8_t, ROWS*COLS>, 3>& occ = friendly ? player.occ : opp.occ;
-        
-        if(n_pieces <= 1)   // 1 or 0
-            occ[0][i] = n_pieces;
-        else // n_pieces >= 2
-        {
-            occ[0][i] = 1;
-            occ[1][i] = 1;
-            occ[2][i] = n_pieces - 2;
-        }
+    player.occ = occ_planes[p_idx];
+    opp.occ = occ_planes[!p_idx];
+    RotatePlanes(opp.occ);
 
-        if(n_pieces > 0)
-        {
-            ++sq_oc_each[!friendly];
-
-            // add one to distance to simulate removal
-            if(friendly)
-                player.pip_count += n_pieces * (GetDistance(coord, {!player_idx, COLS-1}) + 1);
-            else
-                opp.pip_count += n_pieces * (GetDistance(coord, {player_idx, COLS-1}, !player_idx) + 1);
-        }
-
-    }
+    player.pip_count = pip_counts[p_idx];
+    opp.pip_count = pip_counts[!p_idx];
 
     // pieces off
-    player.pieces_off = pieces_per_player[player_idx] - pieces_left[player_idx];
-    opp.pieces_off = pieces_per_player[!player_idx] - pieces_left[!player_idx];
+    player.pieces_off = pieces_per_player[p_idx] - pieces_left[p_idx];
+    opp.pieces_off = pieces_per_player[!p_idx] - pieces_left[!p_idx];
 
     // pieces not reached home
-    player.pieces_not_reached = pieces_per_player[player_idx] - reached_enemy_home[player_idx];
-    opp.pieces_not_reached = pieces_per_player[!player_idx] - reached_enemy_home[!player_idx];
+    player.pieces_not_reached = pieces_per_player[p_idx] - reached_enemy_home[p_idx];
+    opp.pieces_not_reached = pieces_per_player[!p_idx] - reached_enemy_home[!p_idx];
 
     // legacy: total pieces occupied each
-    player.sq_occ = sq_oc_each[0];
-    opp.sq_occ    = sq_oc_each[1];
+    player.sq_occ = std::popcount(occ_bits[p_idx]);
+    opp.sq_occ    = std::popcount(occ_bits[!p_idx]);
 
     return features;
 }
 
+const Board::Features::OccPlanes& Board::Planes(bool player) const
+{   return occ_planes[player];   }
+
+int Board::PipCount(bool player) const
+{   return pip_counts[player];   }
+
+const std::array<int, 2>& Board::PiecesPerPlayer() const
+{   return pieces_per_player;   }
+
 const Board::Features Board::ExtractFeatures(const BoardConfig& other_data, bool p_idx) const
 {
-    Board helper(other_data);
-    if(helper.PlayerIdx() != p_idx)
-        helper.SwitchPlayer();
-    
-    return helper.ExtractFeatures();
+    return Board(other_data).ExtractFeatures(p_idx);
 }
 
 const Board::Features Board::ExtractFeatures(const BoardConfig& other_data) const
@@ -17,16 +17,24 @@ public:
     const int8_t& at(const Coord& s) const;
     const int8_t& at(size_t r, size_t c) const;
     const BoardConfig& View() const;
+    ZobristKey Key() const;     // Zobrist key of board + side to move, kept incrementally
     
     bool PlayerIdx() const;
     int8_t PlayerSign() const;
     bool HeadUsed() const;
 
     int MaxNumOcc() const;
+
+    // Occupancy bitboards: bit i is point i of `player`'s own path (0 = head,
+    // 23 = last point before bearing off), see Path::Idx.
+    uint32_t OccBits(bool player) const;        // points holding 1+ of player's checkers
+    uint32_t StackBits(bool player) const;      // points holding 2+ of player's checkers
+    uint32_t EnemyBits(bool player) const;      // opponent's occupancy, in player's path order
     const std::array<int, 2>& ReachedEnemyHome() const;
     const std::array<int, 2>& PiecesLeft() const;
 
     // Updates and Actions    
+    void SetPosition(const BoardConfig& b, bool p_idx, bool head = false);   // full reset, e.g. from a GameState
     void Move(const Coord& start, const Coord& end);
     void UndoMove(const Coord& start, const Coord& end);
 
@@ -48,6 +56,8 @@ public:
     bool CurrPlayerInEndgame() const;
 
     // Calculations
+    static uint32_t RotatePath(uint32_t bits);      // re-index a path mask into the other player's order
+
     Coord CoordAfterDistance(const Coord& start, int d, bool player) const;
     Coord CoordAfterDistance(const Coord& start, int d) const;
 
@@ -63,6 +73,8 @@ public:
     //features are from perspective of player whose move it is. Hence, no negative values.
     struct Features
     {
+        using OccPlanes = std::array<std::array<uint8_t, ROWS*COLS>, 3>;
+
         struct PlayerBoardInfo
         {
             /*
@@ -70,7 +82,7 @@ public:
             second "                     " 1 "                                  " with 2 or more pieces
             third "                      " n_pieces - 2 "                       " with 3 or more pieces
             */
-            std::array<std::array<uint8_t, ROWS*COLS>, 3> occ{};    // 0-init
+            OccPlanes occ{};    // 0-init
 
             int pip_count = 0;      // number of 1-moves to remove all pieces
 
@@ -80,6 +92,7 @@ public:
         };
 
         void SwapPerspective();
+        Features Flipped() const;   // same position featured for the other side (occ planes re-indexed)
         
         PlayerBoardInfo player;
         PlayerBoardInfo opp;
@@ -88,12 +101,26 @@ public:
     };
 
     const Features ExtractFeatures() const;
+    const Features ExtractFeatures(bool p_idx) const;   // this position, from p_idx's perspective
     const Features ExtractFeatures(const BoardConfig& other_data) const;
     const Features ExtractFeatures(const BoardConfig& other_data, bool p_idx) const;
 
+    // The pieces ExtractFeatures is built from, for writers that skip the copy.
+    const Features::OccPlanes& Planes(bool player) const;   // along player's own path
+    int PipCount(bool player) const;
+    const std::array<int, 2>& PiecesPerPlayer() const;
+
     friend class ScenarioBuilder;
 private:
     BoardConfig data;
+    ZobristKey zobrist;
+    std::array<uint32_t, 2> occ_bits;
+    std::array<uint32_t, 2> stack_bits;
+
+    // Feature planes and pip counts per player, indexed along that player's own
+    // path. Kept in step with data so ExtractFeatures never rescans the board.
+    std::array<Features::OccPlanes, 2> occ_planes;
+    std::array<int, 2> pip_counts;
 
     bool player_idx;
     int8_t player_sign;
@@ -103,6 +130,8 @@ private:
     std::array<int, 2>  pieces_left;
 
     // Updates and Actions
+    void AddToSquare(const Coord& s, int8_t delta);    // keeps zobrist, bitboards and feature planes in sync with data
+    void UpdateDerived(const Coord& s, int8_t before);
     void OnMove(const Coord& start, const Coord& end);
     void OnUndoMove(const Coord& start, const Coord& end);
 
@@ -112,6 +141,7 @@ private:
     // Manaul Initialization
     void SetData(const BoardConfig& b);
     void CalcPiecesLeftandReached();
+    void CalcDerived();
 };
 
 } // namespace Nardi
\ No newline at end of file
@@ -1,6 +1,8 @@
 #include "Game.h"
 #include "ReaderWriter.h"
 
+#include <bit>
+
 using namespace Nardi;
 
 ///////////////////////////
@@ -11,12 +13,14 @@ using namespace Nardi;
 
 Game::Game(int rseed) : board(), rng(rseed), dist(1, 6), dice({0, 0}), times_dice_used({0, 0}), 
                         turn_number({0, 0}), emitted_game_over(false), doubles_rolled(false), 
+                        first_move_exception(false), maxdice_exception(false), 
                         rw(nullptr), arbiter(*this), legal_turns(*this)
 {} 
 
 Game::Game() :  board(), rng(std::random_device{}()), dist(1, 6), dice({0, 0}), 
                 emitted_game_over(false), doubles_rolled(false), times_dice_used({0, 0}),
-                turn_number({0, 0}), rw(nullptr), arbiter(*this), legal_turns(*this)
+                turn_number({0, 0}), first_move_exception(false), maxdice_exception(false), 
+                rw(nullptr), arbiter(*this), legal_turns(*this)
 {}
 
 Game::Game(const Game& other) : rng(std::random_device{}()), dist(1, 6), rw(nullptr), 
@@ -32,6 +36,7 @@ Game::Game(const Game& other) : rng(std::random_device{}()), dist(1, 6), rw(null
     first_move_exception = other.first_move_exception;
     maxdice_exception = other.maxdice_exception;
     times_dice_used = other.times_dice_used;
+    _afterstate_cache = other._afterstate_cache;
 }
 
 void Game::AttachReaderWriter(ReaderWriter* r)
@@ -42,6 +47,12 @@ void Game::AttachReaderWriter(std::shared_ptr<ReaderWriter> r)
     rw = r.get();
 }
 
+void Game::AttachAfterstateCache(std::shared_ptr<AfterstateCache> cache)
+{   _afterstate_cache = std::move(cache);   }
+
+const std::shared_ptr<AfterstateCache>& Game::GetAfterstateCache() const
+{   return _afterstate_cache;   }
+
 ///////////// Getters /////////////
 
 const Board& Game::GetBoardRef() const
@@ -54,7 +65,7 @@ const BoardConfig& Game::GetBoardData() const
     return board.View();
 }
 
-const std::array<std::unordered_set<Coord, CoordHash>, 2>& Game::GetStarts() const {
+const std::array<uint32_t, 2>& Game::GetStarts() const {
     return starts;
 }
 
@@ -80,11 +91,222 @@ const std::unordered_map<BoardConfig, MoveSequence, BoardConfigHash>& Game::GetB
     return legal_turns.BrdsToSeqs();
 }
 
+Board::Features Game::FeaturesAfter(const MoveSequence& seq)
+{
+    for(PackedMove m : seq)
+        MockMove(m.From(), m.DieIdx());
+
+    Board::Features features = board.ExtractFeatures();
+
+    for(std::size_t k = seq.size(); k-- > 0; )
+        UndoMove(seq[k]);
+
+    return features;
+}
+
+Board::Features Game::FeaturesAfter(const PackedSeq& seq)
+{
+    bool player = board.PlayerIdx();
+    for(int k = 0; k < seq.len; ++k)
+        MockMove(Path::CoordOf(player, seq.PathIdx(k)), seq.DieIdx(k));
+
+    Board::Features features = board.ExtractFeatures();
+
+    for(int k = seq.len - 1; k >= 0; --k)
+        UndoMove(Path::CoordOf(player, seq.PathIdx(k)), seq.DieIdx(k));
+
+    return features;
+}
+
 Game::Snapshot Game::GetSnapshot() const
 {
     return Snapshot(board.PlayerIdx(), board.View(), dice, times_dice_used);
 }
 
+GameState Game::State() const
+{
+    GameState s;
+    s.board = board.View();
+    s.dice = { static_cast<uint8_t>(dice[0]), static_cast<uint8_t>(dice[1]) };
+    s.dice_used = { static_cast<uint8_t>(times_dice_used[0]), static_cast<uint8_t>(times_dice_used[1]) };
+    s.turn_number = { static_cast<uint16_t>(turn_number[0]), static_cast<uint16_t>(turn_number[1]) };
+    s.player_idx = board.PlayerIdx();
+    s.head_used = board.HeadUsed();
+    s.first_move_exception = first_move_exception;
+    s.maxdice_exception = maxdice_exception;
+    return s;
+}
+
+void Game::LoadState(const GameState& s)
+{
+    board.SetPosition(s.board, s.player_idx, s.head_used);
+    SetDice(s.dice[0], s.dice[1]);
+    times_dice_used = { s.dice_used[0], s.dice_used[1] };
+    turn_number = { s.turn_number[0], s.turn_number[1] };
+    first_move_exception = s.first_move_exception;
+    maxdice_exception = s.maxdice_exception;
+    emitted_game_over = false;
+
+    mvs_this_turn.clear();
+    std::stack<TurnData> empty;
+    std::swap(history, empty);
+}
+
+void RollAfterstates::Clear()
+{
+    boards.clear();
+    features.clear();
+    index.clear();
+    offsets.fill(0);
+    slot.clear();
+    turns.clear();
+}
+
+void Game::GenerateAfterstates(const DieType& roll, AfterstateBuffer& out)
+{
+    SetDice(std::max(roll[0], roll[1]), std::min(roll[0], roll[1]));   // larger first, as OnRoll
+    first_move_exception = false;
+    maxdice_exception = false;
+    legal_turns.ComputeAllLegalMoves(out);
+}
+
+///////////// AfterstateCache /////////////
+
+uint64_t AfterstateCache::Key::Hash() const
+{
+    uint64_t flags = dice[0] | dice[1] << 4 | dice_used[0] << 8 | dice_used[1] << 12
+                   | head_used << 16 | first_turn << 17 | first_move_exception << 18 | maxdice_exception << 19;
+    return zobrist ^ (flags * 0x9e3779b97f4a7c15ull);
+}
+
+AfterstateCache::AfterstateCache(size_t capacity, size_t n_shards)
+    : _shardCapacity(std::max<size_t>(1, (capacity + n_shards - 1) / n_shards)),
+      _nShards(std::max<size_t>(1, n_shards)),
+      _shards(std::make_unique<Shard[]>(_nShards))
+{}
+
+bool AfterstateCache::Lookup(const Key& key, AfterstateBuffer& out, Result& result)
+{
+    uint64_t hash = key.Hash();
+    Shard& shard = ShardFor(hash);
+    {
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        auto it = shard.where.find(hash);
+        if(it != shard.where.end())
+        {
+            Entry& e = shard.slots[it->second];
+            if(e.key == key)
+            {
+                e.referenced = true;
+                out.assign(e.turns.begin(), e.turns.end());
+                result = e.result;
+                _hits.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    _misses.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void AfterstateCache::Insert(const Key& key, const AfterstateBuffer& turns, const Result& result)
+{
+    uint64_t hash = key.Hash();
+    Shard& shard = ShardFor(hash);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    uint32_t slot;
+    auto it = shard.where.find(hash);
+    if(it != shard.where.end())
+        slot = it->second;      // same key raced in, or a hash collision: overwrite
+    else if(shard.slots.size() < _shardCapacity)
+    {
+        slot = static_cast<uint32_t>(shard.slots.size());
+        shard.slots.emplace_back();
+        shard.where.emplace(hash, slot);
+    }
+    else
+    {
+        while(shard.slots[shard.hand].referenced)
+        {
+            shard.slots[shard.hand].referenced = false;
+            shard.hand = (shard.hand + 1) % shard.slots.size();
+        }
+        slot = static_cast<uint32_t>(shard.hand);
+        shard.hand = (shard.hand + 1) % shard.slots.size();
+
+        shard.where.erase(shard.slots[slot].hash);
+        shard.where.emplace(hash, slot);
+        _evictions.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Entry& e = shard.slots[slot];
+    e.key = key;
+    e.hash = hash;
+    e.turns.assign(turns.begin(), turns.end());
+    e.result = result;
+    e.referenced = false;
+}
+
+AfterstateCache::Stats AfterstateCache::GetStats() const
+{
+    size_t size = 0;
+    for(size_t i = 0; i < _nShards; ++i)
+    {
+        std::lock_guard<std::mutex> lock(_shards[i].mtx);
+        size += _shards[i].slots.size();
+    }
+    return { _hits.load(std::memory_order_relaxed), _misses.load(std::memory_order_relaxed),
+             _evictions.load(std::memory_order_relaxed), size, _shardCapacity * _nShards };
+}
+
+void AfterstateCache::Clear()
+{
+    for(size_t i = 0; i < _nShards; ++i)
+    {
+        std::lock_guard<std::mutex> lock(_shards[i].mtx);
+        _shards[i].slots.clear();
+        _shards[i].where.clear();
+        _shards[i].hand = 0;
+    }
+    _hits = 0;
+    _misses = 0;
+    _evictions = 0;
+}
+
+void Game::EnumerateAllRolls(RollAfterstates& out)
+{
+    out.Clear();
+
+    DieType saved_dice = dice;
+    bool saved_fme = first_move_exception;
+    bool saved_mde = maxdice_exception;
+
+    legal_turns.ShareFirstSteps(true);
+    for(int r = 0; r < RollAfterstates::N_ROLLS; ++r)
+    {
+        GenerateAfterstates(RollAfterstates::ROLLS[r], out.turns);
+
+        out.offsets[r] = static_cast<uint32_t>(out.index.size());
+        for(const Afterstate& a : out.turns)
+        {
+            auto [it, fresh] = out.slot.try_emplace(a.key, static_cast<uint32_t>(out.boards.size()));
+            if(fresh)
+            {
+                out.boards.push_back(a.board);
+                out.features.push_back(FeaturesAfter(a.seq));
+            }
+            out.index.push_back(it->second);
+        }
+    }
+    out.offsets[RollAfterstates::N_ROLLS] = static_cast<uint32_t>(out.index.size());
+    legal_turns.ShareFirstSteps(false);
+
+    SetDice(saved_dice[0], saved_dice[1]);
+    first_move_exception = saved_fme;
+    maxdice_exception = saved_mde;
+}
+
 ///////////// Gameplay /////////////
 
 status_codes Game::RollDice() // important to force this only once per turn in controller, no explicit safeguard here
@@ -107,7 +329,7 @@ status_codes Game::OnRoll()
     if(dice[0] < dice[1])
         std::swap(dice[0], dice[1]);
 
-    EmitEvent(Event{EventCode::DICE_ROLL, dice, GetSnapshot()});
+    EmitEvent(EventCode::DICE_ROLL, dice);
 
     first_move_exception = false;
     maxdice_exception = false;
@@ -135,9 +357,11 @@ bool Game::AutoPlayTurn(const BoardConfig& key)
     if(!b2s.contains(key))
         return false;
     else{
-        for(const auto& sd : b2s[key])
+        for(PackedMove m : b2s[key])
         {
-            auto status = arbiter.CanMoveByDice(sd._from, sd._diceIdx).first;
+            const Coord& from = m.From();
+            bool dice_idx = m.DieIdx();
+            auto status = arbiter.CanMoveByDice(from, dice_idx).first;
             if( status != status_codes::SUCCESS){
                 DispErrorCode(status);
                 std::cerr << "fme is " << first_move_exception << ", current board:\n";
@@ -145,26 +369,26 @@ bool Game::AutoPlayTurn(const BoardConfig& key)
                 DisplayBoard(board.View());
                 std::cerr << "original board:\n";
                 DisplayBoard(original_brd);
-                std::cerr << "attempted move: " << sd._from.AsStr() << " by " << dice[sd._diceIdx] << "\n";
+                std::cerr << "attempted move: " << from.AsStr() << " by " << m.DieValue() << "\n";
 
                 std::cerr << "full sequence of moves attempting:\n";
-                for (const auto& mv : b2s[key])
-                    std::cerr << mv._from.AsStr() << " by " << dice[mv._diceIdx] << "\n";
+                for (PackedMove mv : b2s[key])
+                    std::cerr << mv.From().AsStr() << " by " << mv.DieValue() << "\n";
 
                 throw std::runtime_error("AutoPlay attempted illegal move");
             }
 
-            UseDice(sd._diceIdx);
-            if(arbiter.DiceRemovesFrom(sd._from, sd._diceIdx)) {
-                board.Remove(sd._from);
-                EmitEvent(Event{EventCode::REMOVE, RemoveData{sd._from, sd._diceIdx}, GetSnapshot()});
+            UseDice(dice_idx);
+            if(arbiter.DiceRemovesFrom(from, dice_idx)) {
+                board.Remove(from);
+                EmitEvent(EventCode::REMOVE, RemoveData{from, dice_idx});
             }
             else {
-                Coord dest = board.CoordAfterDistance(sd._from, dice[sd._diceIdx]);
-                board.Move(sd._from, dest);
-                EmitEvent(Event{EventCode::MOVE, MoveData{sd._from, dest, sd._diceIdx}, GetSnapshot()});
+                Coord dest = board.CoordAfterDistance(from, dice[dice_idx]);
+                board.Move(from, dest);
+                EmitEvent(EventCode::MOVE, MoveData{from, dest, dice_idx});
             }
-            mvs_this_turn.emplace_back(sd._from, sd._diceIdx);
+            mvs_this_turn.push_back(m);
         }
         arbiter.CheckForcedMoves();
         return true;
@@ -237,16 +461,16 @@ status_codes Game::MakeMove(const Coord& start, bool dice_idx)
 {
     if(MockMove(start, dice_idx))
     {
-        mvs_this_turn.emplace_back(start, dice_idx);
+        mvs_this_turn.push_back(PackedMove(board.PlayerIdx(), start, dice_idx, dice[dice_idx]));
 
         Coord end = board.CoordAfterDistance(start, dice[dice_idx]);
 
         if(end.InBounds())
-            EmitEvent(Event{EventCode::MOVE, MoveData{start, end, dice_idx}, GetSnapshot()});
+            EmitEvent(EventCode::MOVE, MoveData{start, end, dice_idx});
         else
-            EmitEvent(Event{EventCode::REMOVE, RemoveData{start, dice_idx}, GetSnapshot()});
+            EmitEvent(EventCode::REMOVE, RemoveData{start, dice_idx});
 
-        return arbiter.CheckForcedMoves();
+        return arbiter.UpdateForcedMoves();
     }
     else
         return status_codes::MISC_FAILURE;
@@ -341,25 +565,25 @@ bool Game::UndoMove(const Coord& start, bool dice_idx)
     return true;
 }
 
-bool Game::UndoMove(const StartAndDice& sd)
+bool Game::UndoMove(PackedMove m)
 {
-    return UndoMove(sd._from, sd._diceIdx);
+    return UndoMove(m.From(), m.DieIdx());
 }
 
 bool Game::UndoLast() {
-    size_t n = mvs_this_turn.size();
-    if(n > 0) {
-        auto [start, dice_idx] = mvs_this_turn[n-1];
+    if(!mvs_this_turn.empty()) {
+        const Coord& start = mvs_this_turn.back().From();
+        bool dice_idx = mvs_this_turn.back().DieIdx();
         UndoMove(start, dice_idx);
         auto dest = board.CoordAfterDistance(start, dice[dice_idx]);
         if (dest.InBounds())
-            EmitEvent(Event{EventCode::MOVE, MoveData{dest, start, dice_idx}, GetSnapshot()});
+            EmitEvent(EventCode::MOVE, MoveData{dest, start, dice_idx});
         else
-            EmitEvent(Event{EventCode::REPLACE, RemoveData{start, dice_idx}, GetSnapshot()});
+            EmitEvent(EventCode::REPLACE, RemoveData{start, dice_idx});
         mvs_this_turn.pop_back();
         // Re-derive legal moves + per-die start sets for the restored position, just
         // like a forward move does — otherwise the start highlights stay stale.
-        arbiter.CheckForcedMoves();
+        arbiter.UpdateForcedMoves();
         return true;
     }
     return false;
@@ -379,8 +603,7 @@ status_codes Game::UndoCurrentTurn()
     board.SwitchPlayer();
     while(!mvs.empty())
     {
-        int last_idx = mvs.size() - 1;
-        UndoMove(mvs[last_idx]);
+        UndoMove(mvs.back());
         mvs.pop_back();
     }
     
@@ -404,7 +627,7 @@ bool Game::GameIsOver() const
     if(over && !emitted_game_over){
         emitted_game_over = true;   // this order is crucial else seg fault as 
                                     // sfml render keeps calling back here
-        EmitEvent(Event{ EventCode::GAME_OVER, std::monostate{}, GetSnapshot() });
+        EmitEvent(EventCode::GAME_OVER);
     }
     return over;
 }
@@ -430,34 +653,33 @@ void Game::SwitchPlayer()
     history.emplace(mvs_this_turn, dice);
     mvs_this_turn.clear();
 
-    EmitEvent(Event{ EventCode::TURN_SWITCH, std::monostate{}, GetSnapshot() });
+    EmitEvent(EventCode::TURN_SWITCH);
 }
 
 void Game::IncrementTurnNumber()
 {   ++turn_number[board.PlayerIdx()];   }
 
-void Game::EmitEvent(const Event& e) const
+void Game::DeliverEvent(const Event& e) const
 {
     if(_recording)
     {
         switch(e.code)
         {
-        case EventCode::MOVE:
+        case EventCode::MOVE:     // an undo moves back down the mover's path
         {
             const auto& md = std::get<MoveData>(e.data);
-            _move_log.push_back({md.from, md.to});
+            bool player = board.PlayerIdx();
+            bool undone = Path::Idx(player, md.to) < Path::Idx(player, md.from);
+            const Coord& start = undone ? md.to : md.from;
+            _move_log.push_back({PackedMove(player, start, md.die_idx, dice[md.die_idx]), undone});
             break;
         }
         case EventCode::REMOVE:   // borne off: destination is off-board
-        {
-            const auto& rd = std::get<RemoveData>(e.data);
-            _move_log.push_back({rd._from, Coord{}});
-            break;
-        }
         case EventCode::REPLACE:  // undo of a bear-off: checker returns from off
         {
             const auto& rd = std::get<RemoveData>(e.data);
-            _move_log.push_back({Coord{}, rd._from});
+            PackedMove m(board.PlayerIdx(), rd._from, rd._diceIdx, dice[rd._diceIdx]);
+            _move_log.push_back({m, e.code == EventCode::REPLACE});
             break;
         }
         default:
@@ -535,6 +757,27 @@ status_codes Game::Arbiter::BoardAndBlockLegal(const Coord& start, bool dice_idx
 }
 
 status_codes Game::Arbiter::BoardAndBlockLegalEnd(const Coord& start, bool dice_idx)
+{
+    status_codes result = BoardLegalEnd(start, dice_idx);
+
+    if(result == status_codes::SUCCESS && !_g.first_move_exception && _blockMonitor.Illegal(start, dice_idx))
+        return status_codes::BAD_BLOCK;
+    else
+        return result;
+}
+
+status_codes Game::Arbiter::BoardLegal(const Coord& start, bool dice_idx)
+{
+    status_codes can_start = _g.board.ValidStart(start);
+
+    if(can_start != status_codes::SUCCESS)
+        return can_start;
+    else
+        return BoardLegalEnd(start, dice_idx);
+}
+
+// Everything but the bad-block rule
+status_codes Game::Arbiter::BoardLegalEnd(const Coord& start, bool dice_idx)
 {
     if(!CanUseDice(dice_idx))
         return status_codes::DICE_USED_ALREADY;
@@ -554,22 +797,15 @@ status_codes Game::Arbiter::BoardAndBlockLegalEnd(const Coord& start, bool dice_
     Coord final_dest = _g.board.CoordAfterDistance(start, _g.dice[dice_idx]);
     status_codes result = _g.board.WellDefinedEnd(start, final_dest);
     
-    if(result != status_codes::SUCCESS)
-    {
-        if( DiceRemovesFrom(start, dice_idx))
-        {
-            if(_blockMonitor.Illegal(start, dice_idx))
-                return status_codes::BAD_BLOCK;
-            else
-                return status_codes::SUCCESS;
-        }
-        else
-            return result;
-    }
-    else if (_blockMonitor.Illegal(start, dice_idx))
-        return status_codes::BAD_BLOCK;
+    if(result != status_codes::SUCCESS && DiceRemovesFrom(start, dice_idx))
+        return status_codes::SUCCESS;
     else
-        return result;  // success
+        return result;
+}
+
+bool Game::Arbiter::CompletesBlock(const Coord& start, bool dice_idx)
+{
+    return _blockMonitor.Completes(start, dice_idx);
 }
 
 std::pair<status_codes, Coord> Game::Arbiter::CanFinishByDice(const Coord& start, bool dice_idx)
@@ -586,10 +822,10 @@ std::pair<status_codes, Coord> Game::Arbiter::CanFinishByDice(const Coord& start
 
 bool Game::Arbiter::DiceRemovesFrom(const Coord& start, bool dice_idx)
 {
-    if(!_g.board.CurrPlayerInEndgame())
+    if(!_g.board.CurrPlayerInEndgame() || start.OutOfBounds())
         return false;
     
-    int pos_from_end = COLS - start.col;
+    int pos_from_end = Path::LEN - Path::Idx(_g.board.PlayerIdx(), start);
     return (pos_from_end == _g.dice[dice_idx] ||  // dice val exactly
             (pos_from_end >= _g.board.MaxNumOcc() && _g.dice[dice_idx] > pos_from_end) );  
                 // largest available is less than dice
@@ -604,6 +840,9 @@ bool Game::Arbiter::CanUseDice(bool idx, int n) const
 std::pair<status_codes, std::array<int, 2>> Game::Arbiter::LegalMove(const Coord& start, const Coord& end)    
 // array represents how many times each dice is used, 0 or 1 usually, in case of doubles can be up to 4
 {    
+    if(start.OutOfBounds() || end.OutOfBounds())
+        return {status_codes::OUT_OF_BOUNDS, {}};
+
     int d = _g.board.GetDistance(start, end);
 
     if(d == _g.dice[0])
@@ -681,27 +920,38 @@ status_codes Game::Arbiter::CheckForcedMoves()
 {    
     _g.legal_turns.ComputeAllLegalMoves();
 
-    _g.starts[0].clear();
-    _g.starts[1].clear();
+    _g.starts = { 0, 0 };
 
     if(_g.legal_turns.BrdsToSeqs().empty())
         return status_codes::NO_LEGAL_MOVES_LEFT;   // no moves: leave both start sets empty
-    else{
-        auto coord = _g.PlayerHead();
+    else if(!_g.legal_turns.GraphStarts(_g.starts))
+    {
+        // no turn graph (the first-move exception): probe each checker
+        bool player = _g.board.PlayerIdx();
+        for(uint32_t occ = _g.board.OccBits(player); occ; occ &= occ - 1)
+        {
+            int path_idx = std::countr_zero(occ);
+            const Coord& coord = Path::CoordOf(player, path_idx);
+            if(CanMoveByDice(coord, 0).first == status_codes::SUCCESS)
+                _g.starts[0] |= 1u << path_idx;
+            if(CanMoveByDice(coord, 1).first == status_codes::SUCCESS)
+                _g.starts[1] |= 1u << path_idx;
+        }
+    }
 
-        while(coord.InBounds()) {
-            if(CanMoveByDice(coord, 0).first == status_codes::SUCCESS){
-                _g.starts[0].insert(coord);
-            }
-            if(CanMoveByDice(coord, 1).first == status_codes::SUCCESS){
-                _g.starts[1].insert(coord);
-            }
+    return status_codes::SUCCESS;
+}
 
-            coord = _g.board.CoordAfterDistance(coord, 1);
-        }
+// Within a turn, narrow the turn graph left by the last full computation
+// instead of searching again.
+status_codes Game::Arbiter::UpdateForcedMoves()
+{
+    if(!_g.legal_turns.NarrowToCurrent())
+        return CheckForcedMoves();
 
-        return status_codes::SUCCESS;
-    }
+    _g.starts = { 0, 0 };
+    _g.legal_turns.GraphStarts(_g.starts);
+    return _g.legal_turns.BrdsToSeqs().empty() ? status_codes::NO_LEGAL_MOVES_LEFT : status_codes::SUCCESS;
 }
 
 ///////////////////////////////////////
@@ -715,9 +965,11 @@ Game::LegalSeqComputer::LegalSeqComputer(Game& g, const LegalSeqComputer& other)
     _maxDice = other._maxDice;
     _dieIdxs = other._dieIdxs;
     _encountered = other._encountered;
+    _leaves = other._leaves;
 
     _maxLen = other._maxLen;
     _brdsToSeqs = other._brdsToSeqs;
+    // the turn graph stays behind: a copy recomputes in full on its next sub-move
 }
 
 int Game::LegalSeqComputer::MaxLen() const {
@@ -735,7 +987,71 @@ std::unordered_map<BoardConfig, MoveSequence, BoardConfigHash>& Game::LegalSeqCo
 void Game::LegalSeqComputer::ComputeAllLegalMoves()
 {
     _brdsToSeqs.clear();
+    ClearTurnGraph();
+
+    if(UseTurnGraph())
+    {
+        _maxDice = (_g.dice[1] > _g.dice[0]);
+        _dieIdxs = { _maxDice, !_maxDice };
+        uint32_t root = BuildNode();
+
+        // only one die can be played: it must be the larger one if that can move
+        const TurnNode& node = _nodes[root];
+        if(node.depth == 1 && !_g.doubles_rolled && _g.arbiter.CanUseDice(0) && _g.arbiter.CanUseDice(1))
+        {
+            const TurnEdge* first = _edges.data() + node.first_edge;
+            const TurnEdge* last = first + node.n_edges;
+            if(std::any_of(first, last, [&](const TurnEdge& e) { return e.die_idx == _maxDice; }) &&
+               std::any_of(first, last, [&](const TurnEdge& e) { return e.die_idx != _maxDice; }))
+                _g.maxdice_exception = true;
+        }
+
+        CollectTurns(root);
+        return;
+    }
+
+    ComputeAllLegalMoves(_scratch);
+
+    bool player = _g.board.PlayerIdx();
+    for(const auto& a : _scratch)
+        _brdsToSeqs.emplace(a.board, a.seq.Unpack(player, _g.dice));
+}
+
+void Game::LegalSeqComputer::ComputeAllLegalMoves(AfterstateBuffer& out)
+{
+    AfterstateCache* cache = _g._afterstate_cache.get();
+    if(!cache)
+    {
+        Generate(out);
+        return;
+    }
+
+    bool player = _g.board.PlayerIdx();
+    AfterstateCache::Key key{ _g.board.View(), _g.board.Key(),
+                              { static_cast<uint8_t>(_g.dice[0]), static_cast<uint8_t>(_g.dice[1]) },
+                              { static_cast<uint8_t>(_g.times_dice_used[0]), static_cast<uint8_t>(_g.times_dice_used[1]) },
+                              _g.board.HeadUsed(), _g.turn_number[player] == 0,
+                              _g.first_move_exception, _g.maxdice_exception };
+
+    AfterstateCache::Result result;
+    if(cache->Lookup(key, out, result))
+    {
+        _maxLen = result.max_len;
+        _g.first_move_exception = result.first_move_exception;
+        _g.maxdice_exception = result.maxdice_exception;
+        return;
+    }
+
+    Generate(out);
+    cache->Insert(key, out, { _maxLen, _g.first_move_exception, _g.maxdice_exception });
+}
+
+void Game::LegalSeqComputer::Generate(AfterstateBuffer& out)
+{
+    out.clear();
+    _out = &out;
     _encountered.clear();
+    _leaves.clear();
 
     _maxLen = 0;
     _maxDice = (_g.dice[1] > _g.dice[0]);
@@ -744,73 +1060,459 @@ void Game::LegalSeqComputer::ComputeAllLegalMoves()
     if(FirstMoveException())
         return;
     
-    std::vector<StartAndDice> seq; 
-    dfs(seq);
+    PackedSeq seq; 
+    if(BearOffApplies())
+    {
+        bool player = _g.board.PlayerIdx();
+        for(int p = 0; p < 6; ++p)
+            _home[p] = std::max(_g.board.PlayerSign() * _g.board.at(Path::CoordOf(player, Path::HOME + p)), 0);
+        _homeRoot = _home;
+        _homeEnemy = _g.board.EnemyBits(player) >> Path::HOME;
+        _homeUsed = _g.times_dice_used;
+        BearOffDfs(seq, 0);
+    }
+    else if(_g.doubles_rolled)
+        DoublesDfs(seq, 0);
+    else
+        dfs(seq);
 
     if(_maxLen == 1 && !_g.doubles_rolled && _g.arbiter.CanUseDice(0) && _g.arbiter.CanUseDice(1))   // non-doubles, only possible to use 1 not both of the dice
     {
-        bool max_dice_possible = std::any_of(_brdsToSeqs.begin(), _brdsToSeqs.end(), 
-            [&](const auto& pair) {
-                return pair.second.at(0)._diceIdx == _maxDice;
-            });
-        if(max_dice_possible)
+        // Decided on the sub-moves, not the afterstates: a bear-off with either
+        // die can leave the same board, kept once, under the larger die.
+        bool player = _g.board.PlayerIdx();
+        std::array<bool, 2> playable = { false, false };
+        for(uint32_t occ = _g.board.OccBits(player); occ; occ &= occ - 1)
         {
-            auto orig_size = _brdsToSeqs.size();
-
-            std::erase_if(_brdsToSeqs, [&](const auto& item){
-                return item.second.at(0)._diceIdx != _maxDice;
+            const Coord& coord = Path::CoordOf(player, std::countr_zero(occ));
+            for(int die = 0; die < 2; ++die)
+                playable[die] = playable[die] || _g.arbiter.BoardAndBlockLegal(coord, die) == status_codes::SUCCESS;
+        }
+        if(playable[0] && playable[1])
+        {
+            std::erase_if(out, [&](const Afterstate& a){
+                return a.seq.DieIdx(0) != _maxDice;
             });
-            _g.maxdice_exception = _brdsToSeqs.size() != orig_size;
+            _g.maxdice_exception = true;
         }
     }
 }
 
-void Game::LegalSeqComputer::dfs(std::vector<StartAndDice>& seq)
+void Game::LegalSeqComputer::ShareFirstSteps(bool on)
+{
+    _shareFirstSteps = on;
+    _firstKnown = 0;
+}
+
+// This roll's legal first steps with `die`. A step that completes a block goes
+// through the full check: whether it can be opened again depends on the other die.
+uint32_t Game::LegalSeqComputer::FirstSteps(bool die)
 {
-    size_t oldSize = seq.size();
+    bool player = _g.board.PlayerIdx();
+    int value = _g.dice[die];
+    if(!(_firstKnown >> value & 1))
+    {
+        uint32_t steps = 0, blocks = 0;
+        for(uint32_t occ = _g.board.OccBits(player); occ; occ &= occ - 1)
+        {
+            int path_idx = std::countr_zero(occ);
+            const Coord& coord = Path::CoordOf(player, path_idx);
+            if(_g.arbiter.BoardLegal(coord, die) != status_codes::SUCCESS)
+                continue;
+            if(_g.arbiter.CompletesBlock(coord, die))
+                blocks |= 1u << path_idx;
+            else
+                steps |= 1u << path_idx;
+        }
+        _firstSteps[value] = steps;
+        _firstBlocks[value] = blocks;
+        _firstKnown |= 1u << value;
+    }
+
+    uint32_t steps = _firstSteps[value];
+    for(uint32_t b = _firstBlocks[value]; b; b &= b - 1)
+        if(_g.arbiter.BoardAndBlockLegal(Path::CoordOf(player, std::countr_zero(b)), die) == status_codes::SUCCESS)
+            steps |= b & -b;
+    return steps;
+}
+
+void Game::LegalSeqComputer::dfs(PackedSeq& seq)
+{
+    int oldLen = seq.len;
     
     for(int i = 0; i < 2; ++i)
     {
         if(!_g.arbiter.CanUseDice(_dieIdxs[i]))
             continue;
 
-        for(Coord coord = _g.PlayerHead(); coord.InBounds(); coord = _g.board.CoordAfterDistance(coord, 1))
+        // only occupied points can start a move; walk them in path order
+        bool player = _g.board.PlayerIdx();
+        bool shared = _shareFirstSteps && seq.len == 0;
+        for(uint32_t occ = shared ? FirstSteps(_dieIdxs[i]) : _g.board.OccBits(player); occ; occ &= occ - 1)
         {
-            if(_g.arbiter.BoardAndBlockLegal(coord, _dieIdxs[i]) == status_codes::SUCCESS)
+            int path_idx = std::countr_zero(occ);
+            const Coord& coord = Path::CoordOf(player, path_idx);
+            if(shared || _g.arbiter.BoardAndBlockLegal(coord, _dieIdxs[i]) == status_codes::SUCCESS)
             {
-                seq.emplace_back(coord, _dieIdxs[i]);
+                seq.Push(path_idx, _dieIdxs[i]);
                 _g.MockMove(coord, _dieIdxs[i]);
 
-                BoardConfig brdkey = _g.board.View();
-                if(! _encountered.contains(brdkey) ) 
+                ZobristKey nodekey = NodeKey();
+                if(! _encountered.contains(nodekey) ) 
                 {
                     dfs(seq);
-                    _encountered.insert(brdkey);
+                    _encountered.insert(nodekey);
                 }
 
                 _g.UndoMove(coord, _dieIdxs[i]);
-                seq.pop_back();
+                seq.Pop();
+            }
+        }
+    }
+
+    if(oldLen == seq.len && seq.len >= _maxLen && seq.len > 0)  // no further legal moves left, valid length sequence found
+    {
+        if(seq.len > _maxLen)
+        {
+            _maxLen = seq.len;
+            _out->clear();      // all previous insertions were not complete turns
+            _leaves.clear();
+        }
+        ZobristKey key = _g.board.Key();
+        if(_leaves.insert(key))   // first time reaching this end board
+            _out->push_back({_g.board.View(), key, seq});
+    }
+}
+
+// Doubles: every sub-move uses the same die, so a turn is a multiset of start
+// points and the final board depends only on the multiset. Walk start points in
+// non-decreasing path order, which reaches each multiset once with no
+// transpositions to prune. That order is also the most permissive one: a checker
+// is moved on only after it arrives, and checkers further back enter home and
+// leave the higher points before any bear-off that needs them gone. It is the
+// first order dfs would find, so turns and their sequences come out the same.
+void Game::LegalSeqComputer::DoublesDfs(PackedSeq& seq, int min_idx)
+{
+    int oldLen = seq.len;
+
+    if(_g.arbiter.CanUseDice(0))
+    {
+        bool player = _g.board.PlayerIdx();
+        bool shared = _shareFirstSteps && seq.len == 0;
+        uint32_t from = shared ? FirstSteps(0) : _g.board.OccBits(player);
+        for(uint32_t occ = from & ~((1u << min_idx) - 1); occ; occ &= occ - 1)
+        {
+            int path_idx = std::countr_zero(occ);
+            const Coord& coord = Path::CoordOf(player, path_idx);
+            if(shared || _g.arbiter.BoardAndBlockLegal(coord, 0) == status_codes::SUCCESS)
+            {
+                seq.Push(path_idx, 0);
+                _g.MockMove(coord, 0);
+                DoublesDfs(seq, path_idx);
+                _g.UndoMove(coord, 0);
+                seq.Pop();
             }
         }
     }
 
-    if(oldSize == seq.size() && seq.size() >= _maxLen && !seq.empty())  // no further legal moves left, valid length sequence found
+    if(oldLen == seq.len && seq.len >= _maxLen && seq.len > 0)
+    {
+        if(seq.len > _maxLen)
+        {
+            _maxLen = seq.len;
+            _out->clear();
+        }
+        _out->push_back({_g.board.View(), _g.board.Key(), seq});
+    }
+}
+
+// Once every checker of the mover is home the head rule cannot apply, and the
+// bad-block rule can only while the opponent has no checker in its own home.
+bool Game::LegalSeqComputer::BearOffApplies() const
+{
+    return _g.board.CurrPlayerInEndgame() && !_g.first_move_exception &&
+           _g.board.ReachedEnemyHome()[!_g.board.PlayerIdx()] > 0;
+}
+
+// dfs (DoublesDfs with doubles) on the home counts alone: same sub-moves in the
+// same order, so the same turns, sequences and output order, without touching
+// the board until a turn is emitted. Home point p is 6 - p from off.
+void Game::LegalSeqComputer::BearOffDfs(PackedSeq& seq, int min_p)
+{
+    int oldLen = seq.len;
+    bool doubles = _g.doubles_rolled;
+
+    for(int i = 0; i < 2 - doubles; ++i)
+    {
+        bool die = _dieIdxs[i];
+        int d = _g.dice[die];
+        if(_homeUsed[die] + 1 > 1 + doubles * (3 - _homeUsed[!die]))    // Arbiter::CanUseDice
+            continue;
+        if(_g.maxdice_exception && d < _g.dice[!die])
+            continue;
+
+        int furthest = 0;
+        while(furthest < 6 && _home[furthest] == 0)
+            ++furthest;
+
+        for(int p = std::max(min_p, furthest); p < 6; ++p)
+        {
+            if(_home[p] == 0)
+                continue;
+
+            int dest = p + d;
+            if(dest < 6)
+            {
+                if(_homeEnemy >> dest & 1u)
+                    continue;
+                ++_home[dest];
+            }
+            else if(dest > 6 && p != furthest)  // a higher die bears off only from the furthest point
+                continue;
+            --_home[p];
+            ++_homeUsed[die];
+            seq.Push(Path::HOME + p, die);
+
+            if(doubles)
+                BearOffDfs(seq, p);
+            else
+            {
+                // as dfs: the same home counts with the other die left are a different position
+                ZobristKey code = static_cast<ZobristKey>(_homeUsed[0] | _homeUsed[1] << 4) << 24;
+                for(int q = 0; q < 6; ++q)
+                    code |= static_cast<ZobristKey>(_home[q]) << (4 * q);
+                if(!_encountered.contains(code))
+                {
+                    BearOffDfs(seq, 0);
+                    _encountered.insert(code);
+                }
+            }
+
+            seq.Pop();
+            --_homeUsed[die];
+            ++_home[p];
+            if(dest < 6)
+                --_home[dest];
+        }
+    }
+
+    if(oldLen == seq.len && seq.len >= _maxLen && seq.len > 0)
+    {
+        if(seq.len > _maxLen)
+        {
+            _maxLen = seq.len;
+            _out->clear();
+            _leaves.clear();
+        }
+        EmitBearOff(seq);
+    }
+}
+
+// Builds the afterstate from the root board and the changed home counts.
+void Game::LegalSeqComputer::EmitBearOff(const PackedSeq& seq)
+{
+    ZobristKey code = 0;
+    for(int q = 0; q < 6; ++q)
+        code |= static_cast<ZobristKey>(_home[q]) << (4 * q);
+    if(!_g.doubles_rolled && !_leaves.insert(code))
+        return;
+
+    bool player = _g.board.PlayerIdx();
+    int8_t sign = _g.board.PlayerSign();
+    BoardConfig board = _g.board.View();
+    ZobristKey key = _g.board.Key();
+    for(int p = 0; p < 6; ++p)
+        if(_home[p] != _homeRoot[p])
+        {
+            const Coord& c = Path::CoordOf(player, Path::HOME + p);
+            int8_t n = static_cast<int8_t>(sign * _home[p]);
+            key ^= Zobrist::Cell(c.row, c.col, board[c.row][c.col]) ^ Zobrist::Cell(c.row, c.col, n);
+            board[c.row][c.col] = n;
+        }
+    _out->push_back({board, key, seq});
+}
+
+ZobristKey Game::LegalSeqComputer::NodeKey() const
+{
+    // with doubles only the total used matters: either die index is the same move
+    uint64_t used = _g.doubles_rolled ? _g.times_dice_used[0] + _g.times_dice_used[1]
+                                      : _g.times_dice_used[0] | _g.times_dice_used[1] << 4;
+    uint64_t flags = _g.dice[0] | _g.dice[1] << 4 | used << 8
+                   | _g.board.HeadUsed() << 16 | _g.first_move_exception << 17 | _g.maxdice_exception << 18;
+    return _g.board.Key() ^ (flags * 0x9e3779b97f4a7c15ull);
+}
+
+// Every roll but the first-turn head exception, which Generate plays as a fixed
+// sequence. The cache serves generator-mode search only: the start masks need
+// the graph, so turns and starts come out the same with or without one.
+bool Game::LegalSeqComputer::UseTurnGraph() const
+{
+    return !FirstMoveApplies();
+}
+
+void Game::LegalSeqComputer::ClearTurnGraph()
+{
+    if(!_nodes.empty())
+        std::fill(_nodeSlots.begin(), _nodeSlots.end(), 0);
+    _nodes.clear();
+    _edges.clear();
+    _endBoards.clear();
+    _current = NO_NODE;
+}
+
+// Slot holding `key`'s node, or the empty slot where it would go.
+uint32_t* Game::LegalSeqComputer::NodeSlot(ZobristKey key)
+{
+    if(_nodeSlots.empty())
+        return nullptr;
+
+    std::size_t mask = _nodeSlots.size() - 1;
+    std::size_t i = key & mask;
+    while(_nodeSlots[i] != 0 && _nodes[_nodeSlots[i] - 1].key != key)
+        i = (i + 1) & mask;
+    return &_nodeSlots[i];
+}
+
+uint32_t Game::LegalSeqComputer::BuildNode()
+{
+    if(2 * (_nodes.size() + 1) > _nodeSlots.size())   // keep load <= 1/2
+    {
+        std::vector<uint32_t> old(_nodeSlots.empty() ? 256 : 2 * _nodeSlots.size(), 0);
+        old.swap(_nodeSlots);
+        for(uint32_t slot : old)
+            if(slot != 0)
+                *NodeSlot(_nodes[slot - 1].key) = slot;
+    }
+
+    ZobristKey key = NodeKey();
+    uint32_t* slot = NodeSlot(key);
+    if(*slot != 0)
+        return *slot - 1;
+
+    uint32_t id = static_cast<uint32_t>(_nodes.size());
+    *slot = id + 1;
+    _nodes.push_back({ key, 0, 0, 0, 0, 0 });
+
+    // same sub-moves as dfs; doubles walk die 0 alone (GraphStarts offers both indices)
+    std::array<TurnEdge, 2 * PIECES_PER_PLAYER> edges;
+    int n_edges = 0;
+    int depth = 0;
+    bool player = _g.board.PlayerIdx();
+    for(int i = 0; i < 2 - _g.doubles_rolled; ++i)
     {
-        if(seq.size() > _maxLen)
+        if(!_g.arbiter.CanUseDice(_dieIdxs[i]))
+            continue;
+
+        for(uint32_t occ = _g.board.OccBits(player); occ; occ &= occ - 1)
         {
-            _maxLen = seq.size();
-            _brdsToSeqs.clear();    // all previous insertions were not complete turns
+            int path_idx = std::countr_zero(occ);
+            const Coord& coord = Path::CoordOf(player, path_idx);
+            if(_g.arbiter.BoardAndBlockLegal(coord, _dieIdxs[i]) == status_codes::SUCCESS)
+            {
+                _g.MockMove(coord, _dieIdxs[i]);
+                uint32_t child = BuildNode();
+                _g.UndoMove(coord, _dieIdxs[i]);
+
+                edges[n_edges++] = { child, static_cast<uint8_t>(path_idx), _dieIdxs[i] };
+                depth = std::max(depth, 1 + _nodes[child].depth);
+            }
         }
-        BoardConfig key = _g.board.View();
-        if(!_brdsToSeqs.contains(key)){
-            _brdsToSeqs.emplace(key, seq);
+    }
+
+    uint32_t board = 0;
+    if(n_edges == 0)    // kept so CollectTurns need not replay the sub-moves
+    {
+        board = static_cast<uint32_t>(_endBoards.size());
+        _endBoards.push_back(_g.board.View());
+    }
+    _nodes[id] = { key, static_cast<uint32_t>(_edges.size()), static_cast<uint8_t>(n_edges), static_cast<int8_t>(depth), 0, board };
+    _edges.insert(_edges.end(), edges.begin(), edges.begin() + n_edges);
+    return id;
+}
+
+bool Game::LegalSeqComputer::NarrowToCurrent()
+{
+    uint32_t* slot = NodeSlot(NodeKey());
+    if(!slot || *slot == 0)
+        return false;
+
+    CollectTurns(*slot - 1);
+    return true;
+}
+
+bool Game::LegalSeqComputer::GraphStarts(std::array<uint32_t, 2>& starts) const
+{
+    if(_current == NO_NODE)
+        return false;
+
+    const TurnNode& node = _nodes[_current];
+    bool both = _g.doubles_rolled && _g.arbiter.CanUseDice(1);
+    for(uint32_t e = node.first_edge; e < node.first_edge + node.n_edges; ++e)
+        if(OnLongestTurn(node, _edges[e]))
+        {
+            uint32_t bit = 1u << _edges[e].path_idx;
+            starts[_edges[e].die_idx] |= bit;
+            if(both)
+                starts[1] |= bit;
         }
+    return true;
+}
+
+// A sub-move is legal if it keeps the longest completion available (and, when
+// only one die can be played, uses the larger die).
+bool Game::LegalSeqComputer::OnLongestTurn(const TurnNode& node, const TurnEdge& edge) const
+{
+    if(1 + _nodes[edge.child].depth != node.depth)
+        return false;
+    return !(_g.maxdice_exception && _g.dice[edge.die_idx] < _g.dice[!edge.die_idx]);
+}
+
+// Fills BrdsToSeqs with the max-length turns on from node `id` (the current position).
+void Game::LegalSeqComputer::CollectTurns(uint32_t id)
+{
+    _current = id;
+    _maxLen = _nodes[id].depth;
+    _brdsToSeqs.clear();
+
+    ++_visit;
+    PackedSeq seq;
+    CollectTurns(id, seq);
+}
+
+void Game::LegalSeqComputer::CollectTurns(uint32_t id, PackedSeq& seq)
+{
+    TurnNode& node = _nodes[id];
+    if(node.visit == _visit)
+        return;
+    node.visit = _visit;
+
+    if(node.depth == 0)
+    {
+        if(seq.len > 0)
+            _brdsToSeqs.emplace(_endBoards[node.board], seq.Unpack(_g.board.PlayerIdx(), _g.dice));
+        return;
     }
+
+    for(uint32_t e = node.first_edge; e < node.first_edge + node.n_edges; ++e)
+    {
+        const TurnEdge edge = _edges[e];
+        if(!OnLongestTurn(node, edge))
+            continue;
+
+        seq.Push(edge.path_idx, edge.die_idx);
+        CollectTurns(edge.child, seq);
+        seq.Pop();
+    }
+}
+
+bool Game::LegalSeqComputer::FirstMoveApplies() const
+{
+    return _g.turn_number[_g.board.PlayerIdx()] == 0 && _g.doubles_rolled && (_g.dice[0] == 4 || _g.dice[0] == 6);
 }
 
 bool Game::LegalSeqComputer::FirstMoveException()   // fixme re-compute mid turn
 {
-    if (_g.turn_number[_g.board.PlayerIdx()] == 0 && _g.doubles_rolled && (_g.dice[0] == 4 || _g.dice[0] == 6 ) ) // first move exception
+    if (FirstMoveApplies()) // first move exception
     {
         /*
         
@@ -818,7 +1520,8 @@ bool Game::LegalSeqComputer::FirstMoveException()   // fixme re-compute mid turn
         6, 6 case: 6 square is distance 18 from enemy home, 18 > 12 and 18/4 = 4.5 so not reachable
         
         */
-        MoveSequence seq;
+        bool player = _g.board.PlayerIdx();
+        PackedSeq seq;
 
         Coord head = _g.PlayerHead();
         Coord mid(_g.board.PlayerIdx(), 4);
@@ -832,7 +1535,7 @@ bool Game::LegalSeqComputer::FirstMoveException()   // fixme re-compute mid turn
         while( at_head > PIECES_PER_PLAYER - 2)
         {
             _g.MockMove(head, 0);
-            seq.emplace_back(head, 0);
+            seq.Push(Path::Idx(player, head), 0);
             --at_head;
             ++n_moves;
         }
@@ -844,23 +1547,22 @@ bool Game::LegalSeqComputer::FirstMoveException()   // fixme re-compute mid turn
             while (at_dest < 2)
             {
                 _g.MockMove(mid, 0);
-                seq.emplace_back(mid, 0);   
+                seq.Push(Path::Idx(player, mid), 0);
                 ++at_dest;
                 ++n_2moves;
             }
         }
 
-        if(!seq.empty())
+        if(seq.len > 0)
         {
-            BoardConfig key = _g.board.View();
-            _brdsToSeqs.emplace(key, seq);
+            _out->push_back({_g.board.View(), _g.board.Key(), seq});
 
             if(_g.dice[0] == 6 && abs(_g.board.at(_g.board.PlayerIdx(), 6)) != 2 )
             {
                 std::cout << "seqs was:\n";
-                for (auto& sd : seq)
+                for (PackedMove m : seq.Unpack(player, _g.dice))
                 {
-                    std::cout << sd._from.AsStr() << " by " << _g.dice[sd._diceIdx] << "\n";
+                    std::cout << m.From().AsStr() << " by " << m.DieValue() << "\n";
                 }
                 DisplayBoard(_g.board.View());
                 std::cout << "curr player idx is " << _g.board.PlayerIdx() << "\n";
@@ -872,9 +1574,9 @@ bool Game::LegalSeqComputer::FirstMoveException()   // fixme re-compute mid turn
             {
                 DisplayBoard(_g.board.View());
                 std::cout << "seqs was:\n";
-                for (auto& sd : seq)
+                for (PackedMove m : seq.Unpack(player, _g.dice))
                 {
-                    std::cout << sd._from.AsStr() << " by " << _g.dice[sd._diceIdx] << "\n";
+                    std::cout << m.From().AsStr() << " by " << m.DieValue() << "\n";
                 }
                 throw std::runtime_error("First Move error on 4 4");
             }
@@ -4,13 +4,16 @@
 #include "Board.h"
 
 #include <array>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <stack>
 #include <algorithm>
 #include <ranges>
 #include <unordered_set>
 #include <unordered_map>
 #include <random>
+#include <type_traits>
 
 /*
 Undo Mock via stack
@@ -33,6 +36,150 @@ namespace Nardi
 
 class ReaderWriter;
 
+/*
+Everything the rules need to resume a position, as a plain value: trivially
+copyable and under a cache line, so search can hold and copy positions freely
+and load them into one reusable Game (Game::LoadState) instead of copying a
+whole Game with its history, legal-move tables and rng.
+*/
+struct GameState
+{
+    BoardConfig board;
+    std::array<uint8_t, 2> dice;
+    std::array<uint8_t, 2> dice_used;
+    std::array<uint16_t, 2> turn_number;
+    bool player_idx;
+    bool head_used;
+    bool first_move_exception;
+    bool maxdice_exception;
+};
+static_assert(std::is_trivially_copyable_v<GameState>);
+static_assert(sizeof(GameState) <= 64);
+
+// One generated turn: the end board, its Board::Key() (side to move not yet
+// switched) and the sub-moves that reach it. Generator-mode movegen writes these
+// into a caller-owned AfterstateBuffer, cleared but not freed between calls.
+struct Afterstate
+{
+    BoardConfig board;
+    ZobristKey key;
+    PackedSeq seq;
+};
+using AfterstateBuffer = std::vector<Afterstate>;
+
+/*
+Afterstates of one pre-roll position under all 21 distinct rolls, ordered
+(1,1), (1,2) .. (1,6), (2,2) .. (6,6). A board reachable under several rolls
+(e.g. 1-4 and 2-3 both moving one checker 5) is stored and featured once;
+roll r's afterstates are boards[index[i]] for offsets[r] <= i < offsets[r + 1].
+Reuse one instance across calls to keep its buffers.
+*/
+struct RollAfterstates
+{
+    static constexpr int N_ROLLS = 21;
+    static constexpr std::array<DieType, N_ROLLS> ROLLS = {{
+        {1, 1}, {1, 2}, {1, 3}, {1, 4}, {1, 5}, {1, 6},
+                {2, 2}, {2, 3}, {2, 4}, {2, 5}, {2, 6},
+                        {3, 3}, {3, 4}, {3, 5}, {3, 6},
+                                {4, 4}, {4, 5}, {4, 6},
+                                        {5, 5}, {5, 6},
+                                                {6, 6}
+    }};
+
+    std::vector<BoardConfig> boards;        // distinct afterstates
+    std::vector<Board::Features> features;  // boards[i] featured for the side to move
+    std::vector<uint32_t> index;            // per-roll entries into boards
+    std::array<uint32_t, N_ROLLS + 1> offsets{};
+
+    uint32_t Count(int roll) const { return offsets[roll + 1] - offsets[roll]; }
+    void Clear();
+
+    std::unordered_map<ZobristKey, uint32_t, ZobristKeyHash> slot;   // dedup scratch: afterstate key -> boards index
+    AfterstateBuffer turns;                                           // one roll's generator output
+};
+
+/*
+Bounded memo of movegen results, shared by every Game it is attached to (copies
+of a Game share their original's cache), and safe to use from several threads.
+The key is everything LegalSeqComputer reads: board, side, dice, dice used, head
+used, whether it is the mover's first turn and the incoming exception flags;
+the value is the afterstate list plus the flags and max length it produced.
+Entries are split over shards, each behind its own mutex and evicted by a clock
+sweep; evicted slots keep their buffers, so a warm cache stops allocating.
+*/
+class AfterstateCache
+{
+    public:
+        struct Key
+        {
+            BoardConfig board;
+            ZobristKey zobrist;     // Board::Key() of board + side to move
+            std::array<uint8_t, 2> dice;
+            std::array<uint8_t, 2> dice_used;
+            bool head_used;
+            bool first_turn;
+            bool first_move_exception;
+            bool maxdice_exception;
+
+            bool operator==(const Key&) const = default;
+            uint64_t Hash() const;
+        };
+
+        struct Result
+        {
+            int max_len;
+            bool first_move_exception;
+            bool maxdice_exception;
+        };
+
+        struct Stats
+        {
+            uint64_t hits;
+            uint64_t misses;
+            uint64_t evictions;
+            size_t size;
+            size_t capacity;
+
+            double HitRate() const { return hits + misses ? double(hits) / double(hits + misses) : 0.0; }
+        };
+
+        explicit AfterstateCache(size_t capacity, size_t n_shards = 16);
+
+        bool Lookup(const Key& key, AfterstateBuffer& out, Result& result);    // copies into out on a hit
+        void Insert(const Key& key, const AfterstateBuffer& turns, const Result& result);
+
+        Stats GetStats() const;
+        void Clear();   // drops entries and counters
+
+    private:
+        struct Entry
+        {
+            Key key;
+            uint64_t hash;
+            AfterstateBuffer turns;
+            Result result;
+            bool referenced;        // clock bit: set on hit, cleared as the hand passes
+        };
+
+        struct Shard
+        {
+            mutable std::mutex mtx;
+            std::vector<Entry> slots;
+            std::unordered_map<uint64_t, uint32_t> where;   // hash -> slots index
+            size_t hand = 0;
+        };
+
+        size_t _shardCapacity;
+        size_t _nShards;
+        std::unique_ptr<Shard[]> _shards;
+
+        std::atomic<uint64_t> _hits{0};
+        std::atomic<uint64_t> _misses{0};
+        std::atomic<uint64_t> _evictions{0};
+
+        Shard& ShardFor(uint64_t hash) { return _shards[(hash >> 32) % _nShards]; }
+};
+
 class Game
 {
     public:
@@ -43,6 +190,11 @@ class Game
         void AttachReaderWriter(ReaderWriter* r);
         void AttachReaderWriter(std::shared_ptr<ReaderWriter> r);
 
+        // Optional movegen memo (nullptr detaches) for generator-mode search; legal
+        // turns and start sets come out the same with or without one.
+        void AttachAfterstateCache(std::shared_ptr<AfterstateCache> cache);
+        const std::shared_ptr<AfterstateCache>& GetAfterstateCache() const;
+
         // public member structs
         struct Snapshot
         {
@@ -71,12 +223,16 @@ class Game
         using EventData = std::variant<std::monostate, MoveData, RemoveData, DieType>;
 
         // One applied sub-move, recorded for headless animation (no view attached).
-        // `from`/`to` out-of-bounds means off-board: to invalid => borne off,
-        // from invalid => returned from off (undo of a bear-off).
+        // An undone move is logged as the move it reverses, played backwards.
+        // From()/To() out-of-bounds means off-board: To invalid => borne off,
+        // From invalid => returned from off (undo of a bear-off).
         struct LoggedMove
         {
-            Coord from;
-            Coord to;
+            PackedMove move;
+            bool undone;
+
+            Coord From() const { return undone ? move.To() : move.From(); }
+            Coord To() const   { return undone ? move.From() : move.To(); }
         };
 
         enum class EventCode {
@@ -89,10 +245,14 @@ class Game
             QUIT
         };
 
+        // Delivered synchronously, so the snapshot is taken from the game on
+        // demand instead of being copied into every event.
         struct Event {
             EventCode code;
             EventData data;
-            Snapshot  snapshot;
+            const Game* source;
+
+            Snapshot GetSnapshot() const { return source->GetSnapshot(); }
         };
 
         // Gameplay
@@ -128,7 +288,13 @@ class Game
         const Board& GetBoardRef() const;
         const BoardConfig& GetBoardData() const;
         const std::unordered_map<BoardConfig, MoveSequence, BoardConfigHash>& GetBoards2Seqs() const;
-        const std::array<std::unordered_set<Coord, CoordHash>, 2>& GetStarts() const;
+        // Per die, bit i set if the mover's checker at path index i can start a move.
+        const std::array<uint32_t, 2>& GetStarts() const;
+
+        // Mover's features for the afterstate of `seq` (e.g. a GetBoards2Seqs value):
+        // mocked on the live board and undone, so no board is rebuilt or rescanned.
+        Board::Features FeaturesAfter(const MoveSequence& seq);
+        Board::Features FeaturesAfter(const PackedSeq& seq);
 
         int GetDice(bool idx) const;
         int GetTurnNumber(bool player) const;
@@ -137,6 +303,21 @@ class Game
 
         Snapshot GetSnapshot() const;
 
+        // Search state. LoadState replaces the position, dice and turn counters
+        // and drops history; legal moves are stale until dice are next set.
+        GameState State() const;
+        void LoadState(const GameState& s);
+
+        // Enumerate a pre-roll position under every roll in one pass: no events,
+        // no per-roll start sets, first steps worked out once per die value and
+        // shared afterstates featured once. Leaves the position and dice as found;
+        // legal moves are stale afterwards.
+        void EnumerateAllRolls(RollAfterstates& out);
+
+        // Generator-mode movegen for search: set `roll` and write its legal turns
+        // into `out`, without events, start sets or GetBoards2Seqs (left stale).
+        void GenerateAfterstates(const DieType& roll, AfterstateBuffer& out);
+
         // Per-sub-move recording, for animating moves headlessly (no ReaderWriter).
         // Enable around a real move; the log then holds that move's sub-moves in
         // application order (e.g. a checker played with both dice logs two hops).
@@ -170,6 +351,7 @@ class Game
 
                 bool Illegal(const Coord& start, bool dice_idx);
                 bool Illegal(const Coord& start, const Coord& end);
+                bool Completes(const Coord& start, bool dice_idx);
 
             private:
                 Game& _g;                
@@ -191,23 +373,99 @@ class Game
             public:
                 LegalSeqComputer(Game& g);
                 LegalSeqComputer(Game& g, const LegalSeqComputer& other);
-                void ComputeAllLegalMoves();
+                void ComputeAllLegalMoves();                        // fills BrdsToSeqs
+                void ComputeAllLegalMoves(AfterstateBuffer& out);   // fills out only
+
+                // While on, the first steps from the current position are worked out
+                // once per die value and shared by every roll searched (EnumerateAllRolls).
+                void ShareFirstSteps(bool on);
 
                 int MaxLen() const;
                 const std::unordered_map<BoardConfig, MoveSequence, BoardConfigHash>& BrdsToSeqs() const;
                 std::unordered_map<BoardConfig, MoveSequence, BoardConfigHash>& BrdsToSeqs();
+
+                // Incremental path for sub-moves within a turn. The full computation
+                // searches a turn graph: every position reachable this turn (keyed by
+                // board, dice, dice used and flags), its sub-moves and its longest
+                // completion. The legal turns are the max-length paths on from the
+                // current node, and the start masks are the first steps of those paths.
+                // After a sub-move or undo NarrowToCurrent refills BrdsToSeqs and MaxLen
+                // from the graph without searching; it returns false if there is no
+                // graph or the position is not in it. GraphStarts likewise returns
+                // false without a graph.
+                bool NarrowToCurrent();
+                bool GraphStarts(std::array<uint32_t, 2>& starts) const;
             
             private:
                 Game& _g;
                 bool _maxDice;
                 std::array<bool, 2> _dieIdxs;
-                std::unordered_set<BoardConfig, BoardConfigHash> _encountered;
+                ZobristKeySet _encountered;     // NodeKey() of visited mid-turn positions
+                ZobristKeySet _leaves;          // Board::Key() of end boards already emitted
 
                 int _maxLen;
                 std::unordered_map<BoardConfig, MoveSequence, BoardConfigHash> _brdsToSeqs; // possible board configs map to move sequence that form them
-
-                void dfs(std::vector<StartAndDice>& seq);
+                AfterstateBuffer _scratch;      // generator output behind BrdsToSeqs
+                AfterstateBuffer* _out = nullptr;
+
+                void Generate(AfterstateBuffer& out);
+                void dfs(PackedSeq& seq);
+                void DoublesDfs(PackedSeq& seq, int min_idx);
+
+                // Bear-off generator: the mover's six home counts (path order) and the
+                // home points the opponent holds stand in for the board.
+                std::array<int, 6> _home;
+                std::array<int, 6> _homeRoot;
+                uint32_t _homeEnemy = 0;
+                std::array<int, 2> _homeUsed;
+
+                // Per die value, the first steps legal under any roll and those that
+                // complete a six-point block, legal only if the rest of the roll can
+                // open it again; path-index masks, filled on first use.
+                bool _shareFirstSteps = false;
+                std::array<uint32_t, 7> _firstSteps{};
+                std::array<uint32_t, 7> _firstBlocks{};
+                uint8_t _firstKnown = 0;    // bit v: die value v filled in
+
+                uint32_t FirstSteps(bool die);
+
+                bool BearOffApplies() const;
+                void BearOffDfs(PackedSeq& seq, int min_p);
+                void EmitBearOff(const PackedSeq& seq);
+                bool FirstMoveApplies() const;
                 bool FirstMoveException();
+
+                struct TurnEdge
+                {
+                    uint32_t child;
+                    uint8_t path_idx;
+                    bool die_idx;
+                };
+                struct TurnNode
+                {
+                    ZobristKey key;     // NodeKey()
+                    uint32_t first_edge;
+                    uint8_t n_edges;
+                    int8_t depth;       // longest completion from here, in sub-moves
+                    uint32_t visit;     // CollectTurns traversal stamp
+                    uint32_t board;     // index into _endBoards when depth is 0
+                };
+                static constexpr uint32_t NO_NODE = UINT32_MAX;
+                uint32_t _current = NO_NODE;        // node of the position BrdsToSeqs was filled for
+                std::vector<TurnNode> _nodes;
+                std::vector<TurnEdge> _edges;
+                std::vector<BoardConfig> _endBoards;    // boards of the nodes with no sub-move left
+                std::vector<uint32_t> _nodeSlots;   // open addressing on key, node id + 1 (0 = empty)
+                uint32_t _visit = 0;
+
+                bool UseTurnGraph() const;
+                ZobristKey NodeKey() const;
+                void ClearTurnGraph();
+                uint32_t* NodeSlot(ZobristKey key);
+                uint32_t BuildNode();
+                bool OnLongestTurn(const TurnNode& node, const TurnEdge& edge) const;
+                void CollectTurns(uint32_t node);
+                void CollectTurns(uint32_t node, PackedSeq& seq);
         };
 
         // Arbiter, tying these together
@@ -217,10 +475,14 @@ class Game
                 Arbiter(Game& gm);
 
                 status_codes CheckForcedMoves();
+                status_codes UpdateForcedMoves();   // after a sub-move or its undo
 
                 // Legality Checks and helpers
                 status_codes BoardAndBlockLegal(const Coord& start, bool dice_idx);
                 status_codes BoardAndBlockLegalEnd(const Coord& start, bool dice_idx);
+                status_codes BoardLegal(const Coord& start, bool dice_idx);      // without the bad-block rule
+                status_codes BoardLegalEnd(const Coord& start, bool dice_idx);
+                bool CompletesBlock(const Coord& start, bool dice_idx);
 
                 status_codes CanStartFrom(const Coord& start);
                 std::pair<status_codes, Coord> CanMoveByDice(const Coord& start, bool dice_idx);
@@ -245,14 +507,14 @@ class Game
 
         struct TurnData
         {
-            TurnData(MoveSequence& mv, DieType d) : _moves(mv), _dice(d) {}
+            TurnData(const MoveSequence& mv, DieType d) : _moves(mv), _dice(d) {}
             MoveSequence _moves;
             DieType _dice;
         };
 
         Board board;
         // std::stack<std::variant< StartAndDice, std::pair<Coord, Coord> > > mock_hist;    implement and use me `
-        std::vector<StartAndDice> mvs_this_turn;
+        MoveSequence mvs_this_turn;
         std::stack<TurnData> history;
 
         std::mt19937 rng;                           // Mersenne Twister engine
@@ -268,9 +530,10 @@ class Game
         bool maxdice_exception;   // can only play one or the other not both
 
         ReaderWriter* rw;
+        std::shared_ptr<AfterstateCache> _afterstate_cache;
         Arbiter arbiter;
         LegalSeqComputer legal_turns;
-        std::array<std::unordered_set<Coord, CoordHash>, 2> starts;
+        std::array<uint32_t, 2> starts{};          // GetStarts()
 
         mutable std::vector<LoggedMove> _move_log;  // appended by EmitEvent when recording
         bool _recording = false;
@@ -285,7 +548,14 @@ class Game
 
         // Updates
         void IncrementTurnNumber();
-        void EmitEvent(const Event& e) const;
+        // Sim and search games have no reader and do not record, so they skip
+        // building the event altogether.
+        void EmitEvent(EventCode code, const EventData& data = std::monostate{}) const
+        {
+            if(rw || _recording)
+                DeliverEvent(Event{code, data, this});
+        }
+        void DeliverEvent(const Event& e) const;
         
         // Moving
         status_codes MakeMove(const Coord& start, bool dice_idx);
@@ -296,7 +566,7 @@ class Game
     
         bool UndoMove(const Coord& start, const Coord& end);
         bool UndoMove(const Coord& start, bool dice_idx);
-        bool UndoMove(const StartAndDice& sd);
+        bool UndoMove(PackedMove m);
         
 };
 
@@ -1,5 +1,7 @@
 #include "Game.h"
 
+#include <bit>
+
 using namespace Nardi;
 
 ///////////// Turn Completion /////////////
@@ -24,9 +26,10 @@ bool Game::PreventionMonitor::Illegal(const Coord& start, bool dice_idx)
     {
         _g.MockMove(start, dice_idx); // moves or removes as needed
 
-        for(Coord coord(_g.board.PlayerIdx(), 0); coord.InBounds(); coord = _g.board.CoordAfterDistance(coord, 1))
+        bool player = _g.board.PlayerIdx();
+        for(uint32_t occ = _g.board.OccBits(player); occ; occ &= occ - 1)
         {
-            if(_g.arbiter.BoardAndBlockLegal(coord, !dice_idx) == status_codes::SUCCESS)
+            if(_g.arbiter.BoardAndBlockLegal(Path::CoordOf(player, std::countr_zero(occ)), !dice_idx) == status_codes::SUCCESS)
             {
                 _g.UndoMove(start, dice_idx);
                 return false;
@@ -54,39 +57,31 @@ bool Game::BadBlockMonitor::BlockingAll()
     if(!PreConditions())
         return false;
     
-    bool other_player = !_g.board.PlayerIdx();
-    int player_sign = _g.board.PlayerSign();
-    Coord coord(_g.board.PlayerIdx(), COLS - 1);
-    int streak = 0;
-    
-    for(; coord.InBounds(); coord = _g.board.CoordAfterDistance(coord, -1, other_player))
-    {
-        if(_g.board.at(coord) * player_sign > 0)    // friendly occupied
-        {
-            ++streak;
-            if(streak == 6)  // will go over this location and set vars accordingly
-            {
-                _blockStart = coord;
-                _blockLength = streak;
-                coord = _g.board.CoordAfterDistance(coord, -1, other_player);
+    // Work in the other player's path order: the block must be 6+ consecutive
+    // friendly points with no enemy checker further along the enemy's path.
+    bool player = _g.board.PlayerIdx();
+    bool other_player = !player;
+    uint32_t friendly = _g.board.EnemyBits(other_player);
+    uint32_t enemy = _g.board.OccBits(other_player);
 
-                while (coord.InBounds() && _g.board.at(coord) * player_sign > 0)
-                {
-                    _blockStart = coord;
-                    ++_blockLength;
-                    coord = _g.board.CoordAfterDistance(coord, -1, other_player);
-                }
+    if(enemy)   // only points beyond the enemy's most advanced checker count
+        friendly &= ~((2u << (31 - std::countl_zero(enemy))) - 1);
 
-                return true; 
-            }
-        }
-        else if(_g.board.at(coord) * player_sign < 0) // enemy occupied
-            return false;   // even if there's a block, enemy has a piece after it
-        else
-            streak = 0;
-    }
+    uint32_t runs = friendly;   // bit i set <=> points i..i+5 all friendly
+    for(int k = 1; k < 6; ++k)
+        runs &= friendly >> k;
 
-    return false;
+    if(!runs)
+        return false;
+
+    int top = 31 - std::countl_zero(runs);      // furthest 6-run; its points are top..top+5
+    uint32_t gaps = ~friendly & ((1u << top) - 1);
+    int lowest = gaps ? 32 - std::countl_zero(gaps) : 0;
+
+    _blockLength = top + 6 - lowest;
+    _blockStart = Path::CoordOf(other_player, lowest);
+
+    return true; 
 }
 
 bool Game::BadBlockMonitor::IsFixable() // reminder the block is already mocked in, also unblocking can never trigger move prevention
@@ -156,6 +151,18 @@ bool Game::BadBlockMonitor::Illegal(const Coord& start, bool dice_idx)
     return ret;
 }
 
+// Whether the move leaves a six-point block, fixable or not: unlike Illegal this
+// depends on the board alone, not on the dice left to open the block again.
+bool Game::BadBlockMonitor::Completes(const Coord& start, bool dice_idx)
+{
+    if(!PreConditions())
+        return false;
+    _g.MockMove(start, dice_idx);
+    bool ret = BlockingAll();
+    _g.UndoMove(start, dice_idx);
+    return ret;
+}
+
 bool Game::BadBlockMonitor::Illegal(const Coord& start, const Coord& end)
 {    
     if(!_g.MockMove(start, end))// updates mock dice used
@@ -29,6 +29,21 @@ void ScenarioBuilder::ResetPreRoll(bool p_idx, const BoardConfig& b)
     ResetControllerState();
 }
 
+GameState ScenarioBuilder::State() const
+{
+    return _game.State();
+}
+
+void ScenarioBuilder::LoadState(const GameState& s)
+{
+    _game.LoadState(s);
+
+    bool sim_mode = _ctrl.sim_mode;
+    ResetControllerState();
+    _ctrl.sim_mode = sim_mode;
+    _ctrl.turn_complete = false;
+}
+
 status_codes ScenarioBuilder::withScenario(bool p_idx, const BoardConfig& b, int d1, int d2, int d1u, int d2u)
 {
     ResetPreRoll(p_idx, b);
@@ -127,6 +142,54 @@ status_codes ScenarioBuilder::SimulateMove(const BoardConfig& b)
     return ret;
 }
 
+ScenarioBuilder::TrustedUndo ScenarioBuilder::ApplyTrusted(const BoardConfig& afterstate)
+{
+    return ApplyTrusted(_game.GetBoards2Seqs().at(afterstate));
+}
+
+ScenarioBuilder::TrustedUndo ScenarioBuilder::ApplyTrusted(const MoveSequence& seq)
+{
+    return ApplyTrusted(PackedSeq::Pack(seq));
+}
+
+ScenarioBuilder::TrustedUndo ScenarioBuilder::ApplyTrusted(const PackedSeq& seq)
+{
+    TrustedUndo undo{ seq, _game.dice, _game.times_dice_used, _game.turn_number,
+                      _game.board.head_used, _game.first_move_exception, _game.maxdice_exception,
+                      _game.emitted_game_over, _ctrl.dice_rolled, _ctrl.start_selected, _ctrl.turn_complete };
+
+    bool player = _game.board.PlayerIdx();
+    for(int k = 0; k < seq.len; ++k)
+        _game.MockMove(Path::CoordOf(player, seq.PathIdx(k)), seq.DieIdx(k));
+
+    _game.IncrementTurnNumber();
+    _game.board.SwitchPlayer();
+    _game.times_dice_used = {0, 0};
+    _ctrl.OnTurnSwitch();
+
+    return undo;
+}
+
+void ScenarioBuilder::UndoTrusted(const TrustedUndo& undo)
+{
+    _game.board.SwitchPlayer();
+    _game.SetDice(undo.dice[0], undo.dice[1]);
+    bool player = _game.board.PlayerIdx();
+    for(int k = undo.seq.len - 1; k >= 0; --k)
+        _game.UndoMove(Path::CoordOf(player, undo.seq.PathIdx(k)), undo.seq.DieIdx(k));
+
+    _game.board.head_used = undo.head_used;
+    _game.times_dice_used = undo.dice_used;
+    _game.turn_number = undo.turn_number;
+    _game.first_move_exception = undo.first_move_exception;
+    _game.maxdice_exception = undo.maxdice_exception;
+    _game.emitted_game_over = undo.emitted_game_over;
+
+    _ctrl.dice_rolled = undo.dice_rolled;
+    _ctrl.start_selected = undo.start_selected;
+    _ctrl.turn_complete = undo.turn_complete;
+}
+
 void ScenarioBuilder::Reset()
 {
     withBoard(TestGlobals::start_brd);
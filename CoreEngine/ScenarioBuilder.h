@@ -22,6 +22,11 @@ class ScenarioBuilder
 
         // setting internals explicitly
         void ResetPreRoll(bool p_idx, const BoardConfig& b);
+
+        // Search state: snapshot the game as a plain value, or load one back.
+        // Loading leaves the controller awaiting a roll (sim mode unchanged).
+        GameState State() const;
+        void LoadState(const GameState& s);
         status_codes withScenario(bool p_idx, const BoardConfig& b, int d1, int d2, int d1u=0, int d2u=0);
         status_codes withScenario(const Game::Snapshot& s);
         status_codes withDice(int d1, int d2, int d1_used = 0, int d2_used = 0);
@@ -38,6 +43,32 @@ class ScenarioBuilder
         status_codes SimulateMove(const BoardConfig& b);
         void Reset();
 
+        // Search kernel: trusted make/unmake of a turn the engine generated for the
+        // current position. ApplyTrusted plays the sequence reaching `afterstate` (a
+        // GetBoards2Seqs() key) and passes the turn, skipping the legality replay,
+        // events, history and forced-move recomputation SimulateMove does.
+        // UndoTrusted restores the position before it, legal moves included, as long
+        // as no dice were set in between (copy the builder to search deeper).
+        // The PackedSeq overload takes an Afterstate from Game::GenerateAfterstates.
+        struct TrustedUndo
+        {
+            PackedSeq seq;
+            DieType dice;
+            std::array<int, 2> dice_used;
+            std::array<int, 2> turn_number;
+            bool head_used;
+            bool first_move_exception;
+            bool maxdice_exception;
+            bool emitted_game_over;
+            bool dice_rolled;
+            bool start_selected;
+            bool turn_complete;
+        };
+        TrustedUndo ApplyTrusted(const BoardConfig& afterstate);
+        TrustedUndo ApplyTrusted(const MoveSequence& seq);  // seq generated for this exact position
+        TrustedUndo ApplyTrusted(const PackedSeq& seq);
+        void UndoTrusted(const TrustedUndo& undo);
+
         void AttachNewRW(const IRWFactory& f);
 
         void DetachRW();
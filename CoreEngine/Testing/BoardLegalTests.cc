@@ -238,7 +238,7 @@ TEST(Calculators, CoordAfterDist)
     for(d = 0; d < COLS; ++d)
         EXPECT_EQ(brd.CoordAfterDistance(head_b, d), Coord(1, d));
 
-    EXPECT_EQ(brd.CoordAfterDistance(head_b, d), Coord(1, 12));
+    EXPECT_EQ(brd.CoordAfterDistance(head_b, d), Coord{});
 
     Coord end_w(1, 11);
     Coord end_b(0, 11);
@@ -252,7 +252,7 @@ TEST(Calculators, CoordAfterDist)
     for(d = 0; d < COLS; ++d)
         EXPECT_EQ(brd.CoordAfterDistance(end_b, -d), Coord(0, 11-d) );
 
-    EXPECT_EQ(brd.CoordAfterDistance(end_b, -d), Coord(0, -1) );
+    EXPECT_EQ(brd.CoordAfterDistance(end_b, -d), Coord{} );
 
     brd.SwitchPlayer(); // same with black now
 
@@ -264,7 +264,7 @@ TEST(Calculators, CoordAfterDist)
     for(; d < COLS; ++d)
         EXPECT_EQ(brd.CoordAfterDistance(head_w, d), Coord(0, d) );
 
-    EXPECT_EQ(brd.CoordAfterDistance(head_w, d), Coord(0, 12));
+    EXPECT_EQ(brd.CoordAfterDistance(head_w, d), Coord{});
     
     for(d = 0; d < COLS; ++d)
         EXPECT_EQ(brd.CoordAfterDistance(end_b, -d), Coord(0, 11-d) );
@@ -274,7 +274,7 @@ TEST(Calculators, CoordAfterDist)
     for(d = 0; d < COLS; ++d)
         EXPECT_EQ(brd.CoordAfterDistance(end_w, -d), Coord(1, 11-d) );
 
-    EXPECT_EQ(brd.CoordAfterDistance(end_w, -d), Coord(1, -1) );
+    EXPECT_EQ(brd.CoordAfterDistance(end_w, -d), Coord{} );
 }
 
 TEST(Calculators, GetDistance)
@@ -61,7 +61,7 @@ TEST_F(TestBuilder, MaxDice)
     EXPECT_EQ(b2s.size(), 1);
     EXPECT_EQ(b2s.begin()->second.size(), 1);
 
-    EXPECT_EQ(b2s.begin()->second.at(0)._diceIdx, second);
+    EXPECT_EQ(b2s.begin()->second.at(0).DieIdx(), second);
 
     rc = ReceiveCommand(Command(0, 0));
     ASSERT_EQ(rc, status_codes::SUCCESS);
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "Testing.h"
+
+#include <random>
+#include <set>
+
+// Legal turns must not depend on the API asked or on an attached AfterstateCache:
+// GetBoards2Seqs and GetStarts (turn graph), with and without a cache, against
+// GenerateAfterstates (dfs / DoublesDfs / BearOffDfs), for every roll.
+
+namespace
+{
+
+struct Position
+{
+    bool p_idx;
+    BoardConfig brd;
+    int white_turns, black_turns;
+};
+
+std::set<BoardConfig> TurnBoards(const Game& g)
+{
+    std::set<BoardConfig> s;
+    for(const auto& [b, seq] : g.GetBoards2Seqs())
+        s.insert(b);
+    return s;
+}
+
+void ExpectConsistent(ScenarioBuilder& builder, const Position& pos,
+                      const std::shared_ptr<AfterstateCache>& cache)
+{
+    for(const auto& roll : RollAfterstates::ROLLS)
+    {
+        int d1 = std::max(roll[0], roll[1]), d2 = std::min(roll[0], roll[1]);
+        SCOPED_TRACE(testing::Message() << "player " << pos.p_idx << " roll " << d1 << "-" << d2);
+
+        builder.withScenario(pos.p_idx, pos.brd, d1, d2);
+        builder.SetTurnNumbers(pos.white_turns, pos.black_turns);
+        builder.GetGame().RefreshForced();
+        auto plain = TurnBoards(builder.GetGame());
+        auto plain_starts = builder.GetGame().GetStarts();
+
+        builder.withScenario(pos.p_idx, pos.brd, d1, d2);
+        builder.SetTurnNumbers(pos.white_turns, pos.black_turns);
+        builder.GetGame().AttachAfterstateCache(cache);
+        builder.GetGame().RefreshForced();
+        auto cached = TurnBoards(builder.GetGame());
+        auto cached_starts = builder.GetGame().GetStarts();
+        builder.GetGame().AttachAfterstateCache(nullptr);
+
+        builder.ResetPreRoll(pos.p_idx, pos.brd);
+        builder.SetTurnNumbers(pos.white_turns, pos.black_turns);
+        AfterstateBuffer buf;
+        builder.GetGame().GenerateAfterstates(roll, buf);
+        std::set<BoardConfig> generated;
+        for(const auto& a : buf)
+            generated.insert(a.board);
+
+        EXPECT_EQ(plain, generated);
+        EXPECT_EQ(cached, generated);
+        EXPECT_EQ(plain_starts, cached_starts);
+    }
+}
+
+} // namespace
+
+TEST(Movegen, BearOffSameBoardBothDice)
+{
+    // Black bears off from its 2-point with either die of 5-2: same board, but
+    // only the 5 leaves a second sub-move, so the 2-first turns must survive.
+    Position pos = { true, {{ { 0, 0, 0, 0, 0, 0, 1,-1, 1,-2,-1,-9 },
+                              { 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 5, 5 } }}, 39, 38 };
+    ScenarioBuilder builder;
+    ExpectConsistent(builder, pos, std::make_shared<AfterstateCache>(1 << 10));
+}
+
+TEST(Movegen, SelfPlayCorpus)
+{
+    std::mt19937 rng(7);
+    std::vector<Position> corpus;
+    ScenarioBuilder builder;
+
+    for(int game = 0; game < 4; ++game)
+    {
+        int turns[2] = { 0, 0 };
+        builder.ResetPreRoll(white, start_brd);
+        builder.SetTurnNumbers(0, 0);
+        for(int ply = 0; ply < 400; ++ply)
+        {
+            Game& g = builder.GetGame();
+            bool p = g.GetBoardRef().PlayerIdx();
+            corpus.push_back({ p, g.GetBoardData(), turns[0], turns[1] });
+
+            AfterstateBuffer buf;
+            g.GenerateAfterstates({ int(rng() % 6 + 1), int(rng() % 6 + 1) }, buf);
+            BoardConfig next = buf.empty() ? g.GetBoardData() : buf[rng() % buf.size()].board;
+
+            int w = 0, b = 0;
+            for(const auto& row : next)
+                for(int v : row)
+                    (v > 0 ? w : b) += std::abs(v);
+            if(w == 0 || b == 0)
+                break;
+
+            ++turns[p];
+            builder.ResetPreRoll(!p, next);
+            builder.SetTurnNumbers(turns[0], turns[1]);
+        }
+    }
+
+    auto cache = std::make_shared<AfterstateCache>(1 << 14);
+    for(const auto& pos : corpus)
+        ExpectConsistent(builder, pos, cache);
+}
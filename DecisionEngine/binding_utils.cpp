@@ -18,52 +18,6 @@ FeaturePipelineKind parse_pipeline_kind(const std::string& kind)
     throw std::runtime_error("Unknown feature pipeline kind. Expected 'legacy' or 'conv'.");
 }
 
-namespace
-{
-
-void fill_feature_matrix(
-    const Nardi::Board::Features& f,
-    float* out,
-    FeaturePipelineKind kind)
-{
-    for(int row = 0; row < 3; ++row)
-        for(int col = 0; col < Nardi::ROWS * Nardi::COLS; ++col)
-            out[row * FEATURE_COLS + col] = static_cast<float>(f.player.occ[row][col]) / FEATURE_SCALE;
-
-    for(int row = 0; row < 3; ++row)
-        for(int col = 0; col < Nardi::ROWS * Nardi::COLS; ++col)
-            out[(row + 3) * FEATURE_COLS + col] = static_cast<float>(f.opp.occ[row][col]) / FEATURE_SCALE;
-
-    std::array<float, FEATURE_ROWS> scalars;
-    if(kind == FeaturePipelineKind::LEGACY)
-    {
-        scalars = {
-            static_cast<float>(f.player.pieces_off),
-            static_cast<float>(f.opp.pieces_off),
-            static_cast<float>(f.player.sq_occ),
-            static_cast<float>(f.opp.sq_occ),
-            static_cast<float>(f.player.pieces_not_reached),
-            static_cast<float>(f.opp.pieces_not_reached)
-        };
-    }
-    else
-    {
-        scalars = {
-            static_cast<float>(f.player.pieces_off),
-            static_cast<float>(f.opp.pieces_off),
-            static_cast<float>(f.player.pip_count),
-            static_cast<float>(f.opp.pip_count),
-            static_cast<float>(f.player.pieces_not_reached),
-            static_cast<float>(f.opp.pieces_not_reached)
-        };
-    }
-
-    for(int row = 0; row < FEATURE_ROWS; ++row)
-        out[row * FEATURE_COLS + (FEATURE_COLS - 1)] = scalars[row] / FEATURE_SCALE;
-}
-
-} // namespace
-
 py::array_t<float> features_to_tensor(
     const Nardi::Board::Features& f,
     const std::string& kind,
@@ -75,13 +29,13 @@ py::array_t<float> features_to_tensor(
     {
         py::array_t<float> arr({py::ssize_t(1), py::ssize_t(FEATURE_ROWS * FEATURE_COLS)});
         auto buf = arr.mutable_unchecked<2>();
-        fill_feature_matrix(f, &buf(0, 0), parsed_kind);
+        write_features(f, parsed_kind, &buf(0, 0));
         return arr;
     }
 
     py::array_t<float> arr({py::ssize_t(1), py::ssize_t(FEATURE_ROWS), py::ssize_t(FEATURE_COLS)});
     auto buf = arr.mutable_unchecked<3>();
-    fill_feature_matrix(f, &buf(0, 0, 0), parsed_kind);
+    write_features(f, parsed_kind, &buf(0, 0, 0));
     return arr;
 }
 
@@ -98,18 +52,52 @@ py::array_t<float> feature_batch_to_tensor(
         py::array_t<float> arr({n, py::ssize_t(FEATURE_ROWS * FEATURE_COLS)});
         auto buf = arr.mutable_unchecked<2>();
         for(py::ssize_t i = 0; i < n; ++i)
-            fill_feature_matrix(features[static_cast<size_t>(i)], &buf(i, 0), parsed_kind);
+            write_features(features[static_cast<size_t>(i)], parsed_kind, &buf(i, 0));
         return arr;
     }
 
     py::array_t<float> arr({n, py::ssize_t(FEATURE_ROWS), py::ssize_t(FEATURE_COLS)});
     auto buf = arr.mutable_unchecked<3>();
     for(py::ssize_t i = 0; i < n; ++i)
-        fill_feature_matrix(features[static_cast<size_t>(i)], &buf(i, 0, 0), parsed_kind);
+        write_features(features[static_cast<size_t>(i)], parsed_kind, &buf(i, 0, 0));
 
     return arr;
 }
 
+py::ssize_t feature_buffer_rows(const py::array& out)
+{
+    if(!py::array_t<float, py::array::c_style>::check_(out))
+        throw std::runtime_error("Feature output buffer must be a C-contiguous float32 array.");
+    if(!out.writeable())
+        throw std::runtime_error("Feature output buffer is read-only.");
+
+    const bool flat = out.ndim() == 2 && out.shape(1) == FEATURE_SIZE;
+    const bool conv = out.ndim() == 3 && out.shape(1) == FEATURE_ROWS && out.shape(2) == FEATURE_COLS;
+    if(!flat && !conv)
+        throw std::runtime_error("Feature output buffer must be shape (N, 150) or (N, 6, 25).");
+    return out.shape(0);
+}
+
+py::ssize_t feature_batch_to_tensor_out(
+    const std::vector<Nardi::Board::Features>& features,
+    py::array out,
+    const std::string& kind)
+{
+    const auto parsed_kind = parse_pipeline_kind(kind);
+    const py::ssize_t n = static_cast<py::ssize_t>(features.size());
+    if(n > feature_buffer_rows(out))
+        throw std::runtime_error("Feature output buffer has fewer rows than features.");
+
+    float* dst = static_cast<float*>(out.mutable_data());
+    py::gil_scoped_release release;
+    for(const auto& f : features)
+    {
+        write_features(f, parsed_kind, dst);
+        dst += FEATURE_SIZE;
+    }
+    return n;
+}
+
 py::array_t<int8_t> board_to_array(const Nardi::BoardConfig& board)
 {
     py::array_t<int8_t> arr({py::ssize_t(Nardi::ROWS), py::ssize_t(Nardi::COLS)});
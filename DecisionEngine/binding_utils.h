@@ -17,16 +17,7 @@ namespace py = pybind11;
 // terminal_value_for_side_to_move, sample_noisy_index) now live in nardi_core.h.
 // This header keeps only the numpy/pybind conversion helpers.
 
-inline constexpr int FEATURE_ROWS = 6;
-inline constexpr int FEATURE_COLS = Nardi::ROWS * Nardi::COLS + 1;
-inline constexpr float FEATURE_SCALE = 15.0f;
-
-enum class FeaturePipelineKind
-{
-    LEGACY,
-    CONV
-};
-
+// The feature block layout and its writer (write_features) are in nardi_core.h.
 FeaturePipelineKind parse_pipeline_kind(const std::string& kind);
 
 py::array_t<float> features_to_tensor(
@@ -39,6 +30,18 @@ py::array_t<float> feature_batch_to_tensor(
     const std::string& kind = "conv",
     bool flatten = false);
 
+// Caller-owned output: `out` must be a writable, C-contiguous float32 array of
+// shape [rows, 150] or [rows, 6, 25] (e.g. a reused or pinned buffer's numpy
+// view). Returns its row capacity; throws if it cannot be filled in place.
+py::ssize_t feature_buffer_rows(const py::array& out);
+
+// Fills the first features.size() rows of `out` (flat or [6,25] as its shape
+// says) without holding the GIL and returns the row count.
+py::ssize_t feature_batch_to_tensor_out(
+    const std::vector<Nardi::Board::Features>& features,
+    py::array out,
+    const std::string& kind = "conv");
+
 py::array_t<int8_t> board_to_array(const Nardi::BoardConfig& board);
 
 std::vector<float> parse_1d_values(
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <memory>
 
 #include <pybind11/pybind11.h>
@@ -32,6 +33,12 @@ public:
         return _net->evaluate_batch(fs);
     }
 
+    std::vector<float> evaluate_siblings(const Nardi::Board::Features& parent,
+                                         const std::vector<Nardi::Board::Features>& fs) const
+    {
+        return _net->evaluate_siblings(parent, fs);
+    }
+
 private:
     std::unique_ptr<InferenceNet> _net;
 };
@@ -111,6 +118,29 @@ PYBIND11_MODULE(nardi, m)
           py::arg("kind") = "conv",
           py::arg("flatten") = false,
           R"(Convert a list of Features objects to a model-ready float tensor buffer.)");
+    m.def("feature_batch_to_tensor_out", &feature_batch_to_tensor_out,
+          py::arg("features"),
+          py::arg("out"),
+          py::arg("kind") = "conv",
+          R"(Write a list of Features objects into the leading rows of a caller-owned
+float32 buffer shaped (N, 150) or (N, 6, 25), e.g. a reused or pinned tensor's
+.numpy() view. Fills without the GIL; returns the number of rows written.)");
+
+    m.def("set_infer_kernels",
+          [](const std::string& kind)
+          {
+              if(kind == "auto")
+                  set_infer_kernels(InferKernels::AUTO);
+              else if(kind == "reference")
+                  set_infer_kernels(InferKernels::REFERENCE);
+              else
+                  throw std::runtime_error("Unknown inference kernels. Expected 'auto' or 'reference'.");
+          },
+          py::arg("kind"),
+          R"(Layer kernels for InferenceNet / target networks loaded afterwards: 'auto'
+(widest SIMD set this CPU supports) or 'reference' (portable scalar parity path).)");
+    m.def("infer_kernels", []() { return std::string(infer_kernel_name()); },
+          R"(Kernel set the next network load uses: 'avx512', 'avx2', 'neon' or 'reference'.)");
 
     py::class_<NardiEngine>(m, "Engine")
         .def(py::init<>())
@@ -215,6 +245,24 @@ top_k>0 expands only the K best by 1-ply value. Requires dice rolled.)")
              R"(Per-root-child 2-ply values (loaded target net), aligned with the last batch.)")
         .def("last_lookahead2_evals", &NardiEngine::last_lookahead2_evals,
              R"(Model-evaluation count of the last 2-ply computation (cost analysis).)")
+        .def("set_move_cache",        &NardiEngine::set_move_cache,
+             py::arg("capacity"),
+             R"(Share a bounded movegen cache across the game and its search copies
+(lookahead workers, MCTS). capacity = max cached entries; 0 disables it.)")
+        .def("move_cache_stats",
+             [](const NardiEngine& eng)
+             {
+                 const auto s = eng.move_cache_stats();
+                 py::dict d;
+                 d["hits"] = s.hits;
+                 d["misses"] = s.misses;
+                 d["evictions"] = s.evictions;
+                 d["size"] = s.size;
+                 d["capacity"] = s.capacity;
+                 d["hit_rate"] = s.HitRate();
+                 return d;
+             },
+             R"(Movegen cache counters: hits, misses, evictions, size, capacity, hit_rate.)")
         .def("configure_players",     &NardiEngine::configure_players,
              py::arg("white"), py::arg("black"),
              R"(Set the per-player move Strategy (white = player idx 0, black = idx 1).)")
@@ -252,6 +300,9 @@ forced pass (TurnPassed), or report the game is over (GameOver).)")
         .def("recent_moves",          &NardiEngine::recent_moves,
              R"(Sub-moves of the last move command as [fromRow,fromCol,toRow,toCol]
 lists, in order; -1 marks off-board (bear-off / replace).)")
+        .def("recent_moves_packed",   &NardiEngine::recent_moves_packed,
+             R"(The same sub-moves as 16-bit ints: bits 0-4 start index on the mover's
+path, 5 die index, 6 bear-off, 7 mover, 8-10 die value, 15 undone.)")
         .def("status_report",       &NardiEngine::status_report)
         .def("status_str",          &NardiEngine::status_str)
         .def("is_terminal",         &NardiEngine::is_terminal)
@@ -397,20 +448,64 @@ nardi_net.export_weights. Torch-free; mirrors model(features) in Python.)")
         .def("evaluate", &PyInferenceNet::evaluate, py::arg("features"),
              R"(Side-to-move value for one Features object.)")
         .def("evaluate_batch", &PyInferenceNet::evaluate_batch, py::arg("features"),
-             R"(Side-to-move values for a list of Features objects.)");
+             R"(Side-to-move values for a list of Features objects.)")
+        .def("evaluate_siblings", &PyInferenceNet::evaluate_siblings, py::arg("parent"), py::arg("features"),
+             R"(evaluate_batch for positions a few checker moves from `parent` (featured for
+the same side): the first layer is computed once for the parent and updated per
+position from the feature cells that differ. Matches evaluate_batch up to
+float rounding.)");
 
     py::class_<LookaheadBatch, std::shared_ptr<LookaheadBatch>>(m, "LookaheadBatch")
         .def_property_readonly("num_children",      &LookaheadBatch::num_children)
         .def_property_readonly("num_eval_features", &LookaheadBatch::num_eval_features)
+        .def_property_readonly("num_leaves",        [](const LookaheadBatch& b) { return b.num_leaves; },
+             R"(Grandchild leaf references before deduplication.)")
+        .def_property_readonly("dedup_ratio",       &LookaheadBatch::dedup_ratio,
+             R"(num_leaves per unique eval position (1.0 = no duplicate leaves).)")
         .def_property_readonly("eval_features",
-             [](const LookaheadBatch& b) { return b.eval_features; },
+             [](const LookaheadBatch& b) { return b.eval_features(); },
              R"(The re-featured grandchild positions (list of Features) the model scores.)")
         .def("tensor",
-             [](const LookaheadBatch& b, const std::string& kind, bool flatten)
-             { return feature_batch_to_tensor(b.eval_features, kind, flatten); },
+             [](const LookaheadBatch& b, const std::string& kind, bool flatten, int start, int count)
+             {
+                 const auto parsed_kind = parse_pipeline_kind(kind);
+                 if(count < 0)
+                     count = std::max(b.num_eval_features() - start, 0);
+                 const py::ssize_t n = count;
+                 py::array_t<float> arr = flatten
+                     ? py::array_t<float>({n, py::ssize_t(FEATURE_SIZE)})
+                     : py::array_t<float>({n, py::ssize_t(FEATURE_ROWS), py::ssize_t(FEATURE_COLS)});
+                 b.write_eval_features(parsed_kind, start, count, arr.mutable_data());
+                 return arr;
+             },
              py::arg("kind") = "conv",
              py::arg("flatten") = false,
-             R"(Return model-ready eval features as [N,6,25] or [N,150].)")
+             py::arg("start") = 0,
+             py::arg("count") = -1,
+             R"(Return model-ready eval features as [N,6,25] or [N,150]; start/count
+select a chunk (count=-1: through the end).)")
+        .def("tensor_out",
+             [](const LookaheadBatch& b, py::array out, const std::string& kind, int start, int count)
+             {
+                 const auto parsed_kind = parse_pipeline_kind(kind);
+                 const py::ssize_t capacity = feature_buffer_rows(out);
+                 if(count < 0)
+                     count = static_cast<int>(std::min<py::ssize_t>(std::max(b.num_eval_features() - start, 0), capacity));
+                 if(count > capacity)
+                     throw std::runtime_error("Feature output buffer has fewer rows than requested.");
+
+                 float* dst = static_cast<float*>(out.mutable_data());
+                 py::gil_scoped_release release;
+                 b.write_eval_features(parsed_kind, start, count, dst);
+                 return count;
+             },
+             py::arg("out"),
+             py::arg("kind") = "conv",
+             py::arg("start") = 0,
+             py::arg("count") = -1,
+             R"(Like tensor(), but writes into the leading rows of a caller-owned float32
+buffer shaped (N, 150) or (N, 6, 25) without the GIL. count=-1 fills as many
+rows from start as remain and fit. Returns the number of rows written.)")
         .def("child_values",                        &lb_child_values,
              py::arg("values"),
              R"(Aggregate leaf values into one value per legal child move.)")
@@ -1,6 +1,6 @@
 #include "lookahead_batch.h"
 
-#include <limits>
+#include <algorithm>
 #include <stdexcept>
 
 namespace nardi_py
@@ -13,17 +13,43 @@ int LookaheadBatch::num_children() const
 
 int LookaheadBatch::num_eval_features() const
 {
-    return static_cast<int>(eval_features.size());
+    return static_cast<int>(eval_positions.size());
+}
+
+float LookaheadBatch::dedup_ratio() const
+{
+    return eval_positions.empty() ? 1.0f : static_cast<float>(num_leaves) / static_cast<float>(eval_positions.size());
+}
+
+std::vector<Nardi::Board::Features> LookaheadBatch::eval_features() const
+{
+    std::vector<Nardi::Board::Features> out;
+    out.reserve(eval_positions.size());
+    for(const auto& pos : eval_positions)
+        out.push_back(pos.ToFeatures());
+    return out;
+}
+
+void LookaheadBatch::write_eval_features(FeaturePipelineKind kind, int begin, int count, float* out) const
+{
+    if(begin < 0 || count < 0 || begin + count > num_eval_features())
+        throw std::runtime_error("Lookahead eval feature range out of bounds.");
+
+    for(int i = begin; i < begin + count; ++i)
+    {
+        write_features(eval_positions[static_cast<size_t>(i)], kind, out);
+        out += FEATURE_SIZE;
+    }
 }
 
 std::vector<float> LookaheadBatch::child_values_vec(const std::vector<float>& values) const
 {
-    if(values.size() != eval_features.size())
+    if(values.size() != eval_positions.size())
         throw std::runtime_error("Lookahead values length does not match eval feature count.");
 
     std::vector<float> out(children.size());
     for(size_t i = 0; i < children.size(); ++i)
-        out[i] = child_value(children[i], values);
+        out[i] = child_value(i, values.data());
     return out;
 }
 
@@ -32,7 +58,7 @@ int LookaheadBatch::best_index_values(const std::vector<float>& values) const
     if(children.empty())
         throw std::runtime_error("Cannot select from an empty lookahead batch.");
 
-    if(values.size() != eval_features.size())
+    if(values.size() != eval_positions.size())
         throw std::runtime_error("Lookahead values length does not match eval feature count.");
 
     // A true winning child is always optimal. Do not compare it against model
@@ -42,11 +68,11 @@ int LookaheadBatch::best_index_values(const std::vector<float>& values) const
             return static_cast<int>(i);
 
     int best = 0;
-    float best_value = child_value(children[0], values);
+    float best_value = child_value(0, values.data());
 
     for(size_t i = 1; i < children.size(); ++i)
     {
-        const float candidate = child_value(children[i], values);
+        const float candidate = child_value(i, values.data());
         if(candidate > best_value)
         {
             best = static_cast<int>(i);
@@ -57,33 +83,31 @@ int LookaheadBatch::best_index_values(const std::vector<float>& values) const
     return best;
 }
 
-float LookaheadBatch::child_value(const ChildChoice& child, const std::vector<float>& values)
+float LookaheadBatch::child_value(size_t child, const float* values) const
 {
-    if(child.terminal_value.has_value())
-        return child.terminal_value.value();
+    if(children[child].terminal_value.has_value())
+        return children[child].terminal_value.value();
+
+    const size_t first = child * N_DICE_COMB;
+    const uint32_t* offsets = group_offsets.data() + first;
+    const float* terminal = group_terminal.data() + first;
+    const int* leaves = group_leaves.data();
 
     float avg_child_eval = 0.0f;
     for(int d_idx = 0; d_idx < N_DICE_COMB; ++d_idx)
     {
-        const DiceGroup& group = child.dice_groups[d_idx];
-        float dice_value;
-
-        if(std::holds_alternative<float>(group.data))
-        {
-            // Terminal opponent wins are already stored from the root player's perspective.
-            dice_value = std::get<float>(group.data);
-        }
-        else
+        // Terminal opponent wins are already stored from the root player's
+        // perspective. Leaves are too, so the opponent chooses the minimum.
+        float dice_value = terminal[d_idx];
+        if(!is_terminal_group(dice_value))
         {
-            // Non-terminal grandchildren are also stored from the root player's perspective,
-            // so the opponent chooses the minimum-valued continuation.
-            const auto& eval_indices = std::get<std::vector<int>>(group.data);
-            if(eval_indices.empty())
+            const uint32_t begin = offsets[d_idx], end = offsets[d_idx + 1];
+            if(begin == end)
                 throw std::runtime_error("Lookahead dice group has no eval indices.");
 
-            dice_value = std::numeric_limits<float>::infinity();
-            for(int eval_idx : eval_indices)
-                dice_value = std::min(dice_value, values.at(static_cast<size_t>(eval_idx)));
+            dice_value = values[leaves[begin]];
+            for(uint32_t k = begin + 1; k < end; ++k)
+                dice_value = std::min(dice_value, values[leaves[k]]);
         }
 
         avg_child_eval += dice_value * COMBO_PROBS[d_idx];
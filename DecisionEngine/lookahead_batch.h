@@ -1,8 +1,9 @@
 #pragma once
 
-#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <optional>
-#include <variant>
 #include <vector>
 
 #include "nardi_core.h"
@@ -18,23 +19,48 @@ namespace nardi_py
 class LookaheadBatch
 {
 public:
-    struct DiceGroup
-    {
-        std::variant<std::vector<int>, float> data;
-    };
-
     struct ChildChoice
     {
         Nardi::BoardConfig board;
         std::optional<float> terminal_value;
-        std::array<DiceGroup, N_DICE_COMB> dice_groups;
     };
 
+    // Marks a dice group that is scored from its leaves.
+    static constexpr float NOT_TERMINAL = std::numeric_limits<float>::quiet_NaN();
+
     std::vector<ChildChoice> children;
-    std::vector<Nardi::Board::Features> eval_features;
+
+    // Opponent dice groups, flat: group g = child * N_DICE_COMB + d_idx, every
+    // child (terminal ones too) owning all N_DICE_COMB of them. A group either
+    // has a terminal value (root player's perspective) or is scored as the
+    // minimum over its leaves, group_leaves[group_offsets[g] .. group_offsets[g + 1]).
+    std::vector<uint32_t> group_offsets{0};
+    std::vector<int> group_leaves;             // indices into eval_positions
+    std::vector<float> group_terminal;         // NOT_TERMINAL unless the opponent wins
+
+    // Grandchild positions the model scores, all featured for the root mover.
+    // Kept as board + side; features and tensors are built only when read.
+    std::vector<EvalPosition> eval_positions;
+
+    // The position the frontier was built from, featured for the root mover
+    // too. Every eval position is a turn by each side away from it, so it is
+    // their common parent for TargetModel::evaluate_siblings.
+    EvalPosition root{};
+
+    // Leaf references across all dice groups before deduplication; each unique
+    // leaf is one eval position.
+    int num_leaves = 0;
 
     int num_children() const;
     int num_eval_features() const;
+    float dedup_ratio() const;   // num_leaves per eval position (1 = no duplicates)
+
+    // Materialised Features of every eval position (the Python eval_features view).
+    std::vector<Nardi::Board::Features> eval_features() const;
+
+    // Model input for eval positions [begin, begin + count), back to back, into
+    // out[count * FEATURE_SIZE].
+    void write_eval_features(FeaturePipelineKind kind, int begin, int count, float* out) const;
 
     // Aggregate per-eval-feature side-to-move `values` into one value per child.
     std::vector<float> child_values_vec(const std::vector<float>& values) const;
@@ -43,8 +69,10 @@ public:
     // shortcuts.
     int best_index_values(const std::vector<float>& values) const;
 
+    static bool is_terminal_group(float terminal) { return !std::isnan(terminal); }
+
 private:
-    static float child_value(const ChildChoice& child, const std::vector<float>& values);
+    float child_value(size_t child, const float* values) const;
 };
 
 } // namespace nardi_py
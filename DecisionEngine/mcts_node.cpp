@@ -31,36 +31,27 @@ std::vector<Nardi::BoardConfig> enumerate_current_dice(Nardi::ScenarioBuilder& b
     return out;
 }
 
-// Set the given dice on a sim-mode builder and return the legal afterstates
-// (empty if the side to move has no legal move).
-std::vector<Nardi::BoardConfig> set_dice_and_enumerate(Nardi::ScenarioBuilder& b, int d1, int d2)
+// Generate the legal afterstates for the given dice into `gen` (generator mode:
+// no controller round-trip, start sets or board->sequence map) and return their
+// boards, in `gen` order (empty if the side to move has no legal move).
+std::vector<Nardi::BoardConfig> set_dice_and_enumerate(Nardi::ScenarioBuilder& b, Nardi::AfterstateBuffer& gen,
+                                                       int d1, int d2)
 {
-    const auto status = b.ReceiveCommand(Nardi::Command(Nardi::DieType{d1, d2}));
-    if(status == Nardi::status_codes::NO_LEGAL_MOVES_LEFT)
-        return {};
-    if(status != Nardi::status_codes::SUCCESS)
-    {
-        Nardi::DispErrorCode(status);
-        throw std::runtime_error("MCTS: unexpected status setting dice.");
-    }
+    b.GetGame().GenerateAfterstates({d1, d2}, gen);
 
-    const auto& b2s = b.GetGame().GetBoards2Seqs();
     std::vector<Nardi::BoardConfig> out;
-    out.reserve(b2s.size());
-    for(const auto& kv : b2s)
-        out.push_back(kv.first);
+    out.reserve(gen.size());
+    for(const auto& a : gen)
+        out.push_back(a.board);
     return out;
 }
 
-// Apply the move reaching `board` and advance to the opponent (sim mode).
-void apply_move(Nardi::ScenarioBuilder& b, const Nardi::BoardConfig& board)
+// Apply a turn just generated on this builder and advance to the opponent; the
+// trusted kernel skips re-validation, and each simulation owns its builder, so
+// the move is never undone.
+void apply_move(Nardi::ScenarioBuilder& b, const Nardi::Afterstate& turn)
 {
-    const auto status = b.SimulateMove(board);
-    if(status != Nardi::status_codes::NO_LEGAL_MOVES_LEFT)
-    {
-        Nardi::DispErrorCode(status);
-        throw std::runtime_error("MCTS: failed to apply a move.");
-    }
+    b.ApplyTrusted(turn.seq);
 }
 
 inline int roll_die(std::mt19937& rng)
@@ -97,10 +88,16 @@ void MCTSTree::run_simulations(int n, Nardi::ScenarioBuilder& root_builder,
 {
     root_dice_idx = combo_index(root_builder.GetGame().GetDice(0),
                                 root_builder.GetGame().GetDice(1));
+    root_boards = enumerate_current_dice(root_builder);
+    root_seqs = root_builder.GetGame().GetBoards2Seqs();
 
+    // One scratch builder for all simulations: reloading the root's GameState is
+    // a small value copy, where copying the builder duplicated the whole Game.
+    const Nardi::GameState root_state = root_builder.State();
+    Nardi::ScenarioBuilder sim_builder(root_builder);
     for(int i = 0; i < n; ++i)
     {
-        Nardi::ScenarioBuilder sim_builder(root_builder); // private copy per simulation
+        sim_builder.LoadState(root_state);
         simulate(root, sim_builder, model, rng, /*is_root=*/true);
     }
 }
@@ -118,13 +115,13 @@ float MCTSTree::simulate(const std::shared_ptr<MCTSNode>& node, Nardi::ScenarioB
     if(is_root)
     {
         d_idx = root_dice_idx;
-        boards = enumerate_current_dice(builder);
+        boards = root_boards;   // builder's legal-move tables are stale after reload
     }
     else
     {
         const int d1 = roll_die(rng);
         const int d2 = roll_die(rng);
-        boards = set_dice_and_enumerate(builder, d1, d2);
+        boards = set_dice_and_enumerate(builder, gen, d1, d2);
         d_idx = combo_index(d1, d2);
     }
 
@@ -141,16 +138,19 @@ float MCTSTree::simulate(const std::shared_ptr<MCTSNode>& node, Nardi::ScenarioB
         if(!slot)
         {
             slot = std::make_shared<MCTSNode>(node->board, cplayer);
-            slot->prior = model.evaluate(features_for(node->board, cplayer));
+            slot->prior = model.evaluate(Nardi::Board(node->board), cplayer);
             slot->prior_set = true;
         }
         child = slot;
     }
     else
     {
-        ensure_moves(bucket, boards, cplayer, model);
+        ensure_moves(bucket, node->board, boards, cplayer, model);
         const Nardi::BoardConfig& chosen = uct_select(bucket, boards);
-        apply_move(builder, chosen);
+        if(is_root)
+            builder.ApplyTrusted(root_seqs.at(chosen));
+        else
+            apply_move(builder, gen[&chosen - boards.data()]);
 
         if(builder.GetGame().GameIsOver())
         {
@@ -227,7 +227,7 @@ float MCTSTree::rollout(Nardi::ScenarioBuilder& builder, TargetModel& model, std
         const bool mover = builder.GetGame().GetBoardRef().PlayerIdx();
         const int d1 = roll_die(rng);
         const int d2 = roll_die(rng);
-        const auto boards = set_dice_and_enumerate(builder, d1, d2);
+        const auto boards = set_dice_and_enumerate(builder, gen, d1, d2);
 
         if(boards.empty())
         {
@@ -241,14 +241,15 @@ float MCTSTree::rollout(Nardi::ScenarioBuilder& builder, TargetModel& model, std
         feats.reserve(boards.size());
         for(const auto& b : boards)
             feats.push_back(features_for(b, !mover));
-        const std::vector<float> vals = model.evaluate_batch(feats);
+        const Nardi::Board& board = builder.GetGame().GetBoardRef();
+        const std::vector<float> vals = model.evaluate_siblings(board.ExtractFeatures(!mover), feats);
 
         size_t best = 0;
         for(size_t i = 1; i < vals.size(); ++i)
             if(vals[i] < vals[best])
                 best = i;
 
-        apply_move(builder, boards[best]);
+        apply_move(builder, gen[best]);
 
         if(builder.GetGame().GameIsOver())
         {
@@ -260,7 +261,8 @@ float MCTSTree::rollout(Nardi::ScenarioBuilder& builder, TargetModel& model, std
     return 0.0f; // unreachable in practice
 }
 
-void MCTSTree::ensure_moves(DiceBucket& bucket, const std::vector<Nardi::BoardConfig>& candidates,
+void MCTSTree::ensure_moves(DiceBucket& bucket, const Nardi::BoardConfig& parent,
+                            const std::vector<Nardi::BoardConfig>& candidates,
                             bool child_player, TargetModel& model)
 {
     std::vector<Nardi::BoardConfig> fresh;
@@ -275,7 +277,7 @@ void MCTSTree::ensure_moves(DiceBucket& bucket, const std::vector<Nardi::BoardCo
     feats.reserve(fresh.size());
     for(const auto& b : fresh)
         feats.push_back(features_for(b, child_player));
-    const std::vector<float> priors = model.evaluate_batch(feats);
+    const std::vector<float> priors = model.evaluate_siblings(features_for(parent, child_player), feats);
 
     for(size_t i = 0; i < fresh.size(); ++i)
     {
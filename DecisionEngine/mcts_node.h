@@ -67,7 +67,8 @@ public:
     MCTSTree(const Nardi::BoardConfig& board, bool player);
 
     // Run `n` simulations. `root_builder` must be at the root (board, player) with
-    // the real dice already rolled, in sim mode; each sim descends a private copy.
+    // the real dice already rolled, in sim mode; each sim descends one scratch
+    // builder reloaded from the root's GameState.
     // The root uses the real dice; deeper chance nodes sample dice by probability.
     void run_simulations(int n, Nardi::ScenarioBuilder& root_builder,
                          TargetModel& model, std::mt19937& rng);
@@ -85,13 +86,21 @@ public:
     static int combo_index(int d1, int d2); // canonical 0..20 index for a dice pair
 
 private:
+    // Real-dice root moves, captured once per run_simulations from root_builder.
+    std::vector<Nardi::BoardConfig> root_boards;
+    std::unordered_map<Nardi::BoardConfig, Nardi::MoveSequence, Nardi::BoardConfigHash> root_seqs;
+    // Below the root: the current step's generated turns, reused across steps.
+    Nardi::AfterstateBuffer gen;
+
     float simulate(const std::shared_ptr<MCTSNode>& node, Nardi::ScenarioBuilder& builder,
                    TargetModel& model, std::mt19937& rng, bool is_root);
     float rollout(Nardi::ScenarioBuilder& builder, TargetModel& model, std::mt19937& rng);
 
     // Create move children (afterstate nodes with model priors) for any candidate
-    // boards not yet in the bucket; batches the model evaluation.
-    void ensure_moves(DiceBucket& bucket, const std::vector<Nardi::BoardConfig>& candidates,
+    // boards not yet in the bucket; batches the model evaluation, as siblings of
+    // `parent`, the board they were played from.
+    void ensure_moves(DiceBucket& bucket, const Nardi::BoardConfig& parent,
+                      const std::vector<Nardi::BoardConfig>& candidates,
                       bool child_player, TargetModel& model);
 
     // UCT (negamax) argmax over a bucket's candidate moves.
@@ -37,27 +37,24 @@ def collect_games_worker(n_games, n_sims, temperature, target_path, max_turns):
     eng = nardi.Engine()
     eng.load_target_network(target_path)
 
-    feature_chunks = []
-    target_chunks = []
+    games = []
     game_lengths = []
 
     for _ in range(n_games):
         pairs = eng.run_mcts_game(n_sims, temperature, max_turns)
         game_lengths.append(len(pairs))
-        if not pairs:
-            continue
-
-        features = [p[0] for p in pairs]
-        targets = np.asarray([p[1] for p in pairs], dtype=np.float32)
-        feature_chunks.append(nardi.feature_batch_to_tensor(features, "conv", False))
-        target_chunks.append(targets)
-
-    if feature_chunks:
-        x = np.concatenate(feature_chunks, axis=0).astype(np.float32, copy=False)
-        y = np.concatenate(target_chunks, axis=0).astype(np.float32, copy=False)
-    else:
-        x = np.empty((0, 6, 25), dtype=np.float32)
-        y = np.empty((0,), dtype=np.float32)
+        if pairs:
+            games.append(pairs)
+
+    # Pack every game's features straight into one preallocated array.
+    n_rows = sum(game_lengths)
+    x = np.empty((n_rows, 6, 25), dtype=np.float32)
+    y = np.empty((n_rows,), dtype=np.float32)
+    row = 0
+    for pairs in games:
+        n = nardi.feature_batch_to_tensor_out([p[0] for p in pairs], x[row:], "conv")
+        y[row:row + n] = [p[1] for p in pairs]
+        row += n
 
     return x, y, game_lengths
 
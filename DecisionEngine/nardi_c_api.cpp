@@ -283,6 +283,21 @@ NardiStatus nardi_get_move(NardiHandle* h, int idx, int out_move[4])
     });
 }
 
+NardiStatus nardi_get_packed_move(NardiHandle* h, int idx, unsigned short* out_move)
+{
+    NARDI_GUARD(h, NARDI_ERR, {
+        if(out_move == nullptr) { h->last_error = "nardi_get_packed_move: null out"; return NARDI_ERR; }
+        const auto moves = h->engine.recent_moves_packed();
+        if(idx < 0 || static_cast<size_t>(idx) >= moves.size())
+        {
+            h->last_error = "nardi_get_packed_move: index out of range";
+            return NARDI_ERR;
+        }
+        *out_move = moves[static_cast<size_t>(idx)];
+        return NARDI_OK;
+    });
+}
+
 NardiStatus nardi_set_position(NardiHandle* h, const signed char* board, int side)
 {
     NARDI_GUARD(h, NARDI_ERR, {
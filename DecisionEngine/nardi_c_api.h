@@ -128,6 +128,11 @@ NardiStatus nardi_confirm_turn(NardiHandle* h);
 int nardi_move_count(NardiHandle* h);                       /* >=0; -1 on error */
 NardiStatus nardi_get_move(NardiHandle* h, int idx, int out_move[4]);
 
+/* The same sub-move as a 16-bit packed move, for compact game records: bits 0-4
+ * start index along the mover's path, 5 die index, 6 bear-off, 7 mover, 8-10
+ * die value, 15 set if the move was undone (played backwards). */
+NardiStatus nardi_get_packed_move(NardiHandle* h, int idx, unsigned short* out_move);
+
 /* --- Analysis mode (board editor + learned-evaluator analysis) ---
  * These drive the sandbox "Analyze" screen, independent of the match loop.
  *
@@ -1,12 +1,86 @@
 #include "nardi_core.h"
 
 #include <algorithm>
+#include <bit>
 #include <cmath>
 #include <stdexcept>
 
 namespace nardi_py
 {
 
+namespace
+{
+
+constexpr int CELLS = FEATURE_COLS - 1;
+
+// One row of the block: a plane's 24 cells, then the row's scalar. `shift`
+// re-indexes a plane kept along the other player's path (point i of one path
+// is point i + COLS of the other).
+void write_row(const std::array<uint8_t, CELLS>& plane, int shift, float scalar, float* out)
+{
+    for(int i = 0; i < CELLS - shift; ++i)
+        out[i] = static_cast<float>(plane[i + shift]) / FEATURE_SCALE;
+    for(int i = CELLS - shift; i < CELLS; ++i)
+        out[i] = static_cast<float>(plane[i + shift - CELLS]) / FEATURE_SCALE;
+    out[CELLS] = scalar / FEATURE_SCALE;
+}
+
+void write_block(const Nardi::Board::Features::OccPlanes& player,
+                 const Nardi::Board::Features::OccPlanes& opp, int opp_shift,
+                 const float (&scalars)[FEATURE_ROWS], float* out)
+{
+    for(int row = 0; row < 3; ++row)
+    {
+        write_row(player[row], 0, scalars[row], out + row * FEATURE_COLS);
+        write_row(opp[row], opp_shift, scalars[row + 3], out + (row + 3) * FEATURE_COLS);
+    }
+}
+
+} // namespace
+
+void write_features(const Nardi::Board::Features& f, FeaturePipelineKind kind, float* out)
+{
+    // Legacy uses square occupancy; conv/res use pip count (see nardi_net.py).
+    const bool legacy = kind == FeaturePipelineKind::LEGACY;
+    const float scalars[FEATURE_ROWS] = {
+        static_cast<float>(f.player.pieces_off),
+        static_cast<float>(f.opp.pieces_off),
+        static_cast<float>(legacy ? f.player.sq_occ : f.player.pip_count),
+        static_cast<float>(legacy ? f.opp.sq_occ : f.opp.pip_count),
+        static_cast<float>(f.player.pieces_not_reached),
+        static_cast<float>(f.opp.pieces_not_reached)
+    };
+    write_block(f.player.occ, f.opp.occ, 0, scalars, out);
+}
+
+void write_features(const Nardi::Board& board, bool side, FeaturePipelineKind kind, float* out)
+{
+    const bool legacy = kind == FeaturePipelineKind::LEGACY;
+    const auto& per_player = board.PiecesPerPlayer();
+    const auto third = [&](bool p) {
+        return static_cast<float>(legacy ? std::popcount(board.OccBits(p)) : board.PipCount(p));
+    };
+    const float scalars[FEATURE_ROWS] = {
+        static_cast<float>(per_player[side] - board.PiecesLeft()[side]),
+        static_cast<float>(per_player[!side] - board.PiecesLeft()[!side]),
+        third(side),
+        third(!side),
+        static_cast<float>(per_player[side] - board.ReachedEnemyHome()[side]),
+        static_cast<float>(per_player[!side] - board.ReachedEnemyHome()[!side])
+    };
+    write_block(board.Planes(side), board.Planes(!side), Nardi::COLS, scalars, out);
+}
+
+Nardi::Board::Features EvalPosition::ToFeatures() const
+{
+    return Nardi::Board(board).ExtractFeatures(side);
+}
+
+void write_features(const EvalPosition& pos, FeaturePipelineKind kind, float* out)
+{
+    write_features(Nardi::Board(pos.board), pos.side, kind, out);
+}
+
 int sample_noisy_index(
     const std::vector<float>& values,
     float eps,
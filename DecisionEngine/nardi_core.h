@@ -34,6 +34,44 @@ inline constexpr float COMBO_PROBS[N_DICE_COMB] = {
                                                                                1.0f / 36.0f
 };
 
+// Model input for one position: a [FEATURE_ROWS, FEATURE_COLS] row-major float
+// block from the side to move's perspective (the legacy / conv pipelines in
+// nardi_net.py).
+//   rows 0-2 : side-to-move occupancy planes over the 24 points of its path
+//   rows 3-5 : opponent occupancy planes, re-indexed onto the same path
+//   last col : pieces off, then squares held (legacy) or pip count (conv/res),
+//              then pieces not yet home -- each side to move first
+// Everything is divided by FEATURE_SCALE.
+inline constexpr int FEATURE_ROWS = 6;
+inline constexpr int FEATURE_COLS = Nardi::ROWS * Nardi::COLS + 1;
+inline constexpr int FEATURE_SIZE = FEATURE_ROWS * FEATURE_COLS;
+inline constexpr float FEATURE_SCALE = 15.0f;
+
+enum class FeaturePipelineKind
+{
+    LEGACY,
+    CONV
+};
+
+// Write one position's block into out[FEATURE_SIZE].
+void write_features(const Nardi::Board::Features& f, FeaturePipelineKind kind, float* out);
+
+// The same block read straight from the board's incrementally kept planes, from
+// `side`'s perspective, without materialising a Features.
+void write_features(const Nardi::Board& board, bool side, FeaturePipelineKind kind, float* out);
+
+// A position to score, stored compactly: the board and the side it is featured
+// for (25 bytes, against ~180 for a materialised Features).
+struct EvalPosition
+{
+    Nardi::BoardConfig board;
+    bool side;
+
+    Nardi::Board::Features ToFeatures() const;
+};
+
+void write_features(const EvalPosition& pos, FeaturePipelineKind kind, float* out);
+
 // Terminal check from the side-to-move's perspective: returns the win margin
 // (1 normal, 2 mars) if the side-to-move has borne off all pieces, else nullopt.
 std::optional<float> terminal_value_for_side_to_move(const Nardi::Board::Features& f);
@@ -1,11 +1,14 @@
 #include "nardi_engine.h"
 
 #include <algorithm>
+#include <bit>
 #include <future>
 #include <iostream>
 #include <limits>
 #include <numeric>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace nardi_py
@@ -14,6 +17,16 @@ namespace nardi_py
 namespace
 {
 
+// Lookahead indexes dice groups by RollAfterstates' roll order.
+static_assert(N_DICE_COMB == Nardi::RollAfterstates::N_ROLLS);
+static_assert([] {
+    for(int r = 0; r < N_DICE_COMB; ++r)
+        if(Nardi::RollAfterstates::ROLLS[r][0] != DICE_COMBOS[r][0]
+            || Nardi::RollAfterstates::ROLLS[r][1] != DICE_COMBOS[r][1])
+            return false;
+    return true;
+}());
+
 std::vector<Nardi::BoardConfig> legal_boards_for_current_dice(const Nardi::ScenarioBuilder& b)
 {
     const auto& b2s = b.GetGame().GetBoards2Seqs();
@@ -188,127 +201,147 @@ std::shared_ptr<LookaheadBatch> NardiEngine::MakeLookaheadBatch()
         return batch;
     }
 
-    _builder.ToSimMode();
-
-    try
+    // Preserve the old simulator shortcut: an immediate win uses the true
+    // terminal result and ignores model-valued alternatives.
+    for(const auto& child_feature : legal_children)
     {
-        for(const auto& child_feature : legal_children)
+        const auto terminal_value = terminal_value_for_side_to_move(child_feature);
+        if(terminal_value.has_value())
         {
             LookaheadBatch::ChildChoice child;
             child.board = child_feature.raw_data;
+            child.terminal_value = terminal_value.value();
+            batch->children.push_back(std::move(child));
+            batch->group_offsets.assign(N_DICE_COMB + 1, 0);
+            batch->group_terminal.assign(N_DICE_COMB, LookaheadBatch::NOT_TERMINAL);
+            _last_lookahead_batch = batch;
+            return batch;
+        }
+    }
 
-            const auto terminal_value = terminal_value_for_side_to_move(child_feature);
-            if(terminal_value.has_value())
-            {
-                child.terminal_value = terminal_value.value();
-                batch->children.clear();
-                batch->eval_features.clear();
-                batch->children.push_back(std::move(child));
-                // Preserve the old simulator shortcut: immediate wins use the
-                // true terminal result and ignore model-valued alternatives.
-                break;
-            }
-
-            auto status = _builder.SimulateMove(child_feature.raw_data);
-            if(status != Nardi::status_codes::NO_LEGAL_MOVES_LEFT)
-            {
-                Nardi::DispErrorCode(status);
-                throw std::runtime_error("Lookahead failed to simulate a child move.");
-            }
-
-            Nardi::ScenarioBuilder after_child(_builder);
+    // Every eval position is stored from the root mover's perspective.
+    const bool root = current_player();
+    batch->root = {_builder.GetGame().GetBoardRef().View(), root};
+    _builder.ToSimMode();
 
-            struct DiceResult
-            {
-                int dice_idx;
-                std::vector<Nardi::Board::Features> features;
-            };
+    try
+    {
+        // Trusted make/unmake: each child was generated for this position, so
+        // reading its GameState skips SimulateMove's replay and the movegen runs
+        // of play + undo.
+        std::vector<Nardi::GameState> after_children;
+        after_children.reserve(legal_children.size());
+        for(const auto& child_feature : legal_children)
+        {
+            const auto undo = _builder.ApplyTrusted(child_feature.raw_data);
+            after_children.push_back(_builder.State());
+            _builder.UndoTrusted(undo);
+        }
 
-            std::vector<std::future<DiceResult>> futures;
-            futures.reserve(N_DICE_COMB);
+        // Enumerate every child's 21 opponent rolls in one pass each. Workers
+        // take children round-robin into their own ScenarioBuilder and write only
+        // their own replies slots; the batch is filled single-threaded after.
+        const size_t n_children = after_children.size();
+        std::vector<Nardi::RollAfterstates> replies(n_children);
+        const size_t n_workers = std::clamp<size_t>(std::thread::hardware_concurrency(), 1, n_children);
 
-            // Fan out the 21 chance outcomes. Every task owns its ScenarioBuilder
-            // copy, so dice-setting and enumeration mutate only thread-local state.
-            for(int d_idx = 0; d_idx < N_DICE_COMB; ++d_idx)
-            {
-                futures.push_back(std::async(
-                    std::launch::async,
-                    [after_child, d_idx]() mutable -> DiceResult
+        std::vector<std::future<void>> futures;
+        futures.reserve(n_workers);
+        for(size_t w = 0; w < n_workers; ++w)
+        {
+            futures.push_back(std::async(
+                std::launch::async,
+                [&after_children, &replies, w, n_workers, n_children,
+                 cache = _builder.GetGame().GetAfterstateCache()]()
+                {
+                    Nardi::ScenarioBuilder scratch;
+                    scratch.ToSimMode();
+                    scratch.GetGame().AttachAfterstateCache(cache);
+                    for(size_t i = w; i < n_children; i += n_workers)
                     {
-                        const auto& dice = DICE_COMBOS[d_idx];
-                        return DiceResult{
-                            d_idx,
-                            NardiEngine::set_and_enumerate(dice[0], dice[1], after_child)
-                        };
-                    }));
-            }
+                        scratch.LoadState(after_children[i]);
+                        scratch.GetGame().EnumerateAllRolls(replies[i]);
+                    }
+                }));
+        }
+        for(auto& future : futures)
+            future.get();
+
+        // Flatten grandchildren into one eval_positions vector. Dice groups are
+        // appended child by child; each holds either a terminal value or a run
+        // of indices into that vector. The same leaf reached from several
+        // children (or several rolls of one) is stored and scored once.
+        std::unordered_map<Nardi::BoardConfig, int, Nardi::BoardConfigHash> leaf_index;
+        std::vector<int> reply_leaf;   // this child's rolls.boards index -> eval index, -1 if unseen
+        const auto add_leaf = [&](const Nardi::BoardConfig& board)
+        {
+            ++batch->num_leaves;
+            auto [it, fresh] = leaf_index.try_emplace(board, batch->num_eval_features());
+            if(fresh)
+                batch->eval_positions.push_back({board, root});
+            return it->second;
+        };
+
+        batch->children.reserve(n_children);
+        batch->group_offsets.reserve(n_children * N_DICE_COMB + 1);
+        batch->group_terminal.reserve(n_children * N_DICE_COMB);
+        for(size_t i = 0; i < n_children; ++i)
+        {
+            LookaheadBatch::ChildChoice child;
+            child.board = legal_children[i].raw_data;
+            const Nardi::RollAfterstates& rolls = replies[i];
+            reply_leaf.assign(rolls.boards.size(), -1);
 
-            // Join before mutating the shared LookaheadBatch. This keeps all batch
-            // writes single-threaded and avoids synchronization inside the batch.
-            std::array<DiceResult, N_DICE_COMB> dice_results;
-            try
-            {
-                for(auto& future : futures)
-                {
-                    DiceResult result = future.get();
-                    dice_results[static_cast<size_t>(result.dice_idx)] = std::move(result);
-                }
-            }
-            catch(...)
+            for(int d_idx = 0; d_idx < N_DICE_COMB; ++d_idx)
             {
-                _builder.ReceiveCommand(Nardi::Command(Nardi::Actions::UNDO_TURN));
-                throw;
-            }
+                auto& leaves = batch->group_leaves;
+                const size_t group_begin = leaves.size();
+                float group_terminal = LookaheadBatch::NOT_TERMINAL;
 
-            const auto& board = after_child.GetGame().GetBoardRef();
-            const bool next_player = !board.PlayerIdx();
-
-            // Flatten grandchildren into one eval_features vector. Dice groups store
-            // either a terminal value or indices into that vector.
-            for(const auto& result : dice_results)
-            {
-                auto& group = child.dice_groups[static_cast<size_t>(result.dice_idx)];
-                if(result.features.empty())
+                if(rolls.Count(d_idx) == 0)
                 {
-                    // No opponent move: the same board becomes the next state, but
-                    // from the root player's side-to-move perspective.
-                    auto& eval_indices = std::get<std::vector<int>>(group.data);
-                    eval_indices.push_back(static_cast<int>(batch->eval_features.size()));
-                    batch->eval_features.push_back(
-                        board.ExtractFeatures(after_child.GetGame().GetBoardData(), next_player)
-                    );
-                    continue;
+                    // No opponent move: the same board becomes the next state,
+                    // scored from the root player's perspective as usual.
+                    leaves.push_back(add_leaf(child.board));
                 }
 
-                for(const auto& f : result.features)
+                for(uint32_t k = rolls.offsets[d_idx]; k < rolls.offsets[d_idx + 1]; ++k)
                 {
+                    const uint32_t reply = rolls.index[k];
+                    const auto& f = rolls.features[reply];
                     const auto opp_terminal_value = terminal_value_for_side_to_move(f);
                     if(opp_terminal_value.has_value())
                     {
                         // The opponent won after the root child, so from the root
                         // player's perspective this child outcome is negative.
                         const float child_terminal_value = -opp_terminal_value.value();
-                        if(std::holds_alternative<float>(group.data)
-                            && std::get<float>(group.data) != child_terminal_value)
+                        if(LookaheadBatch::is_terminal_group(group_terminal)
+                            && group_terminal != child_terminal_value)
                             throw std::runtime_error(
                                 "One opponent dice group produced inconsistent terminal values.");
 
-                        group.data = child_terminal_value;
+                        group_terminal = child_terminal_value;
+                        leaves.resize(group_begin);
                         continue;
                     }
 
-                    if(std::holds_alternative<float>(group.data))
+                    if(LookaheadBatch::is_terminal_group(group_terminal))
                         continue;
 
-                    // Re-feature the opponent's non-terminal reply from the root
-                    // player's perspective before adding it to the model batch.
-                    auto& eval_indices = std::get<std::vector<int>>(group.data);
-                    eval_indices.push_back(static_cast<int>(batch->eval_features.size()));
-                    batch->eval_features.push_back(board.ExtractFeatures(f.raw_data, next_player));
+                    // Queue the opponent's non-terminal reply, to be featured from
+                    // the root player's perspective when the batch is scored.
+                    int& leaf = reply_leaf[reply];
+                    if(leaf < 0)
+                        leaf = add_leaf(f.raw_data);
+                    else
+                        ++batch->num_leaves;
+                    leaves.push_back(leaf);
                 }
+
+                batch->group_terminal.push_back(group_terminal);
+                batch->group_offsets.push_back(static_cast<uint32_t>(leaves.size()));
             }
 
-            _builder.ReceiveCommand(Nardi::Command(Nardi::Actions::UNDO_TURN));
             batch->children.push_back(std::move(child));
         }
     }
@@ -367,7 +400,10 @@ int NardiEngine::greedy_choice(const TargetModel& net) const
     if(const auto terminal_idx = terminal_child_index(children); terminal_idx.has_value())
         return static_cast<int>(terminal_idx.value());
 
-    const std::vector<float> values = net.evaluate_batch(children);
+    // Afterstates of the current board, featured for its mover like they are.
+    const Nardi::Board& board = _builder.GetGame().GetBoardRef();
+    const std::vector<float> values =
+        net.evaluate_siblings(board.ExtractFeatures(current_player()), children);
     return static_cast<int>(
         std::distance(values.begin(), std::max_element(values.begin(), values.end())));
 }
@@ -386,7 +422,7 @@ int NardiEngine::lookahead_choice(const TargetModel& net)
     if(batch->children.empty())
         return -1; // no legal move; the turn passes
 
-    const std::vector<float> values = net.evaluate_batch(batch->eval_features);
+    const std::vector<float> values = net.evaluate_siblings(batch->root, batch->eval_positions);
     return batch->best_index_values(values);
 }
 
@@ -454,36 +490,40 @@ float NardiEngine::oneply_value_to_mover(const Nardi::BoardConfig& board, bool m
     const Nardi::Board& boardref = scratch.GetGame().GetBoardRef();
     float total = 0.0f;
 
+    // All 21 rolls of the mover in one enumeration pass.
+    scratch.ResetPreRoll(mover, board);
+    Nardi::RollAfterstates& rolls = _oneply_rolls;
+    scratch.GetGame().EnumerateAllRolls(rolls);
+    const Nardi::Board::Features parent = boardref.ExtractFeatures(opp);   // of every leaf below
+
     for(int d = 0; d < N_DICE_COMB; ++d)
     {
-        scratch.ResetPreRoll(mover, board);
-        const auto responses = set_and_enumerate(DICE_COMBOS[d][0], DICE_COMBOS[d][1], scratch);
-
         float best;
-        if(responses.empty())
+        if(rolls.Count(d) == 0)
         {
             // Mover cannot move for this roll: it passes to the opponent. Use the
             // static value of the position in the mover's frame.
-            best = -net.evaluate(boardref.ExtractFeatures(board, opp));
+            best = -net.evaluate(boardref, opp);
             ++_last_lookahead2_evals;
         }
         else
         {
             std::vector<Nardi::Board::Features> leaves;
-            leaves.reserve(responses.size());
+            leaves.reserve(rolls.Count(d));
             best = -std::numeric_limits<float>::infinity();
-            for(const auto& f : responses)
+            for(uint32_t k = rolls.offsets[d]; k < rolls.offsets[d + 1]; ++k)
             {
                 // `f` is featured from the mover's perspective, so a terminal
                 // value here is a win for the mover.
+                const auto& f = rolls.features[rolls.index[k]];
                 if(const auto term = terminal_value_for_side_to_move(f); term.has_value())
                     best = std::max(best, term.value());
                 else
-                    leaves.push_back(boardref.ExtractFeatures(f.raw_data, opp));
+                    leaves.push_back(f.Flipped());
             }
             if(!leaves.empty())
             {
-                const auto evals = net.evaluate_batch(leaves);   // value to opponent
+                const auto evals = net.evaluate_siblings(parent, leaves);   // value to opponent
                 _last_lookahead2_evals += static_cast<long>(evals.size());
                 for(float e : evals)
                     best = std::max(best, -e);                    // value to mover
@@ -501,7 +541,7 @@ std::vector<float> NardiEngine::lookahead2_child_values(const TargetModel& net,
     if(batch->children.empty())
         return {};
 
-    const std::vector<float> values1 = net.evaluate_batch(batch->eval_features);
+    const std::vector<float> values1 = net.evaluate_siblings(batch->root, batch->eval_positions);
     _last_lookahead2_evals += static_cast<long>(values1.size());
     const std::vector<float> child1 = batch->child_values_vec(values1);   // one-ply per child
 
@@ -525,27 +565,37 @@ std::vector<float> NardiEngine::lookahead2_child_values(const TargetModel& net,
 
     // Replace the static leaf of each non-terminal grandchild (opponent reply) of
     // an expanded child with that grandchild's one-ply value, then re-aggregate.
+    // Leaves are shared between children, so each is expanded at most once and
+    // a child that is not expanded keeps its one-ply value.
     const bool mover = current_player();
     std::vector<float> values2 = values1;
+    std::vector<char> deepened(values1.size(), 0);
     Nardi::ScenarioBuilder scratch(_builder);
     scratch.SetTurnNumbers(5, 5);   // grandchildren are past the opening; no first-move rule
     for(int ci = 0; ci < static_cast<int>(batch->children.size()); ++ci)
     {
         if(expand.find(ci) == expand.end())
             continue;
-        for(const auto& group : batch->children[static_cast<size_t>(ci)].dice_groups)
+        for(size_t group = static_cast<size_t>(ci) * N_DICE_COMB; group < static_cast<size_t>(ci + 1) * N_DICE_COMB; ++group)
         {
-            if(!std::holds_alternative<std::vector<int>>(group.data))
-                continue;   // terminal opponent dice group (a float) -- keep as is
-            for(int idx : std::get<std::vector<int>>(group.data))
+            if(LookaheadBatch::is_terminal_group(batch->group_terminal[group]))
+                continue;   // terminal opponent dice group -- keep as is
+            for(uint32_t k = batch->group_offsets[group]; k < batch->group_offsets[group + 1]; ++k)
             {
-                const Nardi::BoardConfig g = batch->eval_features[static_cast<size_t>(idx)].raw_data;
-                values2[static_cast<size_t>(idx)] = oneply_value_to_mover(g, mover, net, scratch);
+                const int idx = batch->group_leaves[k];
+                if(std::exchange(deepened[static_cast<size_t>(idx)], 1))
+                    continue;
+                const Nardi::BoardConfig leaf_board = batch->eval_positions[static_cast<size_t>(idx)].board;
+                values2[static_cast<size_t>(idx)] = oneply_value_to_mover(leaf_board, mover, net, scratch);
             }
         }
     }
 
-    return batch->child_values_vec(values2);
+    std::vector<float> child2 = batch->child_values_vec(values2);
+    for(int ci = 0; ci < n; ++ci)
+        if(expand.find(ci) == expand.end())
+            child2[static_cast<size_t>(ci)] = child1[static_cast<size_t>(ci)];
+    return child2;
 }
 
 int NardiEngine::lookahead2_choice(const TargetModel& net, int top_k)
@@ -602,6 +652,18 @@ long NardiEngine::last_lookahead2_evals() const
     return _last_lookahead2_evals;
 }
 
+void NardiEngine::set_move_cache(size_t capacity)
+{
+    _builder.GetGame().AttachAfterstateCache(
+        capacity > 0 ? std::make_shared<Nardi::AfterstateCache>(capacity) : nullptr);
+}
+
+Nardi::AfterstateCache::Stats NardiEngine::move_cache_stats() const
+{
+    const auto& cache = _builder.GetGame().GetAfterstateCache();
+    return cache ? cache->GetStats() : Nardi::AfterstateCache::Stats{};
+}
+
 void NardiEngine::configure_players(Strategy white, Strategy black)
 {
     _player_strats[0] = white;
@@ -732,7 +794,21 @@ std::vector<std::array<int, 4>> NardiEngine::recent_moves() const
     // {fromRow, fromCol, toRow, toCol}; -1 marks off-board (bear-off / replace).
     std::vector<std::array<int, 4>> out;
     for(const auto& m : _builder.GetGame().MoveLog())
-        out.push_back({m.from.row, m.from.col, m.to.row, m.to.col});
+    {
+        Nardi::Coord from = m.From(), to = m.To();
+        out.push_back({from.row, from.col, to.row, to.col});
+    }
+    return out;
+}
+
+std::vector<uint16_t> NardiEngine::recent_moves_packed() const
+{
+    // Same sub-moves as recent_moves, as Nardi::PackedMove bits; bit 15 set
+    // marks an undone move (played backwards).
+    std::vector<uint16_t> out;
+    out.reserve(_builder.GetGame().MoveLog().size());
+    for(const auto& m : _builder.GetGame().MoveLog())
+        out.push_back(static_cast<uint16_t>(m.move.Bits() | (m.undone ? 0x8000u : 0u)));
     return out;
 }
 
@@ -760,9 +836,14 @@ int NardiEngine::starts_mask(int die_idx) const
 {
     if(die_idx != 0 && die_idx != 1)
         return 0;
+    const Nardi::Game& game = _builder.GetGame();
+    const bool player = game.GetBoardRef().PlayerIdx();
     int mask = 0;
-    for(const auto& c : _builder.GetGame().GetStarts()[static_cast<size_t>(die_idx)])
+    for(uint32_t starts = game.GetStarts()[static_cast<size_t>(die_idx)]; starts; starts &= starts - 1)
+    {
+        const Nardi::Coord& c = Nardi::Path::CoordOf(player, std::countr_zero(starts));
         mask |= (1 << (c.row * Nardi::COLS + c.col));   // bit per square, row-major
+    }
     return mask;
 }
 
@@ -885,7 +966,7 @@ std::vector<Nardi::Board::Features> NardiEngine::enumerate(Nardi::status_codes s
     std::vector<Nardi::Board::Features> features_vec;
     features_vec.reserve(b2s.size());
     for(const auto& kv : b2s)
-        features_vec.push_back(_builder.GetGame().GetBoardRef().ExtractFeatures(kv.first));
+        features_vec.push_back(_builder.GetGame().FeaturesAfter(kv.second));
 
     return features_vec;
 }
@@ -926,7 +1007,8 @@ float NardiEngine::debug_target_eval()
 {
     // Evaluate the current board (side-to-move perspective) with the C++ target
     // model. For comparison against the Python model to validate the bridge.
-    return _target_model.evaluate(board_features());
+    const Nardi::Board& board = _builder.GetGame().GetBoardRef();
+    return _target_model.evaluate(board, board.PlayerIdx());
 }
 
 void NardiEngine::set_position(const Nardi::BoardConfig& brd, bool side)
@@ -959,7 +1041,8 @@ float NardiEngine::evaluate_position() const
 {
     if(!_target_model.is_loaded())
         throw std::runtime_error("evaluate_position requires load_target_network(path) first.");
-    return _target_model.evaluate(board_features());
+    const Nardi::Board& board = _builder.GetGame().GetBoardRef();
+    return _target_model.evaluate(board, board.PlayerIdx());
 }
 
 std::vector<std::pair<Nardi::BoardConfig, float>> NardiEngine::analyze_dice(int d1, int d2)
@@ -979,7 +1062,7 @@ std::vector<std::pair<Nardi::BoardConfig, float>> NardiEngine::analyze_dice(int
     if(batch->children.empty())
         return _analyzed;
 
-    const std::vector<float> values = _target_model.evaluate_batch(batch->eval_features);
+    const std::vector<float> values = _target_model.evaluate_siblings(batch->root, batch->eval_positions);
     const std::vector<float> child_vals = batch->child_values_vec(values);
 
     _analyzed.reserve(batch->children.size());
@@ -1246,7 +1329,7 @@ std::vector<Nardi::Board::Features> NardiEngine::set_and_enumerate(
     std::vector<Nardi::Board::Features> features_vec;
     features_vec.reserve(b2s.size());
     for(const auto& kv : b2s)
-        features_vec.push_back(b.GetGame().GetBoardRef().ExtractFeatures(kv.first));
+        features_vec.push_back(b.GetGame().FeaturesAfter(kv.second));
 
     return features_vec;
 }
@@ -140,6 +140,12 @@ public:
     // Model-evaluation count of the last two-ply computation (for cost analysis).
     long last_lookahead2_evals() const;
 
+    // --- Movegen memo shared by the live game and every search copy of it
+    // (lookahead workers, MCTS simulations). capacity = max cached (position,
+    // dice) entries; 0 turns the cache off. Replacing the cache resets its stats.
+    void set_move_cache(size_t capacity);
+    Nardi::AfterstateCache::Stats move_cache_stats() const;   // all zero when off
+
     // --- In-C++ match orchestrator (the turn loop, moved out of Python). The
     // caller repeatedly calls advance(); each step rolls for the current player
     // and either plays a bot move, reports that a human move is awaited, reports
@@ -166,7 +172,7 @@ public:
     bool start_is_selected() const;
     std::array<int, 2> selected_start() const; // {row,col} or {-1,-1}
     // Bitmask of squares that can start a move with die `die_idx` (bit row*COLS+col
-    // set), from the precomputed per-die start sets refreshed by CheckForcedMoves.
+    // set), from the per-die start masks kept by CheckForcedMoves and each sub-move.
     int starts_mask(int die_idx) const;
     // Recompute legal moves + per-die start sets for the current position (used by
     // analysis, which sets dice without going through the match loop's roll).
@@ -179,6 +185,9 @@ public:
     // human_undo), in order, as {fromRow, fromCol, toRow, toCol}; -1 = off-board.
     // Lets the UI animate each sub-move separately (a forced/bot turn can be many).
     std::vector<std::array<int, 4>> recent_moves() const;
+    // The same sub-moves as 16-bit packed moves (see Nardi::PackedMove): start
+    // path index, die index, bear-off, mover and die value; bit 15 = undone.
+    std::vector<uint16_t> recent_moves_packed() const;
 
     void human_turn(bool dice_rolled = false);
     void restart_or_quit();
@@ -240,6 +249,7 @@ private:
     TargetModel _target_model;
     std::mt19937 _rng{std::random_device{}()};
     long _last_lookahead2_evals = 0;   // model evals in the last two-ply computation
+    Nardi::RollAfterstates _oneply_rolls;   // reused by oneply_value_to_mover
 
     // One-ply value to `mover` of a pre-roll position (mover to move): the dice-
     // averaged best move with a static leaf. Used as the two-ply leaf. `scratch`
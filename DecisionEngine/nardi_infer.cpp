@@ -1,12 +1,24 @@
 #include "nardi_infer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <unordered_map>
 
-#include "../CoreEngine/Auxilaries.h"
+#if defined(__x86_64__) || defined(__i386__)
+#define NARDI_INFER_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#define NARDI_INFER_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "nardi_core.h"
 
 namespace nardi_py
 {
@@ -14,16 +26,8 @@ namespace nardi_py
 namespace
 {
 
-// Feature layout, identical to binding_utils::fill_feature_matrix (the conv /
-// legacy pipelines in nardi_net.py): a [6, 25] row-major float matrix.
-//   rows 0-2 : current-player occupancy planes (24 board cells each)
-//   rows 3-5 : opponent occupancy planes
-//   last col : six per-row scalars
-// Everything is divided by FEAT_SCALE.
-constexpr int FEAT_ROWS = 6;
+// Input is the shared [6, 25] feature block (nardi_core.h write_features).
 constexpr int BOARD_COLS = Nardi::ROWS * Nardi::COLS; // 24
-constexpr int FEAT_COLS = BOARD_COLS + 1;             // 25
-constexpr float FEAT_SCALE = 15.0f;
 
 // model-kind tags written by nardi_net.export_weights
 enum class ModelKind : uint32_t
@@ -37,6 +41,8 @@ struct Tensor
 {
     std::vector<int> shape;
     std::vector<float> data;
+    std::vector<int8_t> qdata;   // holds the values instead of data when is_int8
+    bool is_int8 = false;
 
     int dim(int i) const { return shape.at(static_cast<size_t>(i)); }
 };
@@ -81,8 +87,9 @@ Blob read_blob(const std::string& path)
     if(!in || magic[0] != 'N' || magic[1] != 'R' || magic[2] != 'D' || magic[3] != 'W')
         throw std::runtime_error("nardi_infer: bad magic in '" + path + "' (expected NRDW)");
 
+    // version 2 tags every tensor with its element type (int8 blobs)
     const uint32_t version = read_u32(in);
-    if(version != 1u)
+    if(version != 1u && version != 2u)
         throw std::runtime_error("nardi_infer: unsupported weight blob version");
 
     Blob blob;
@@ -95,8 +102,16 @@ Blob read_blob(const std::string& path)
         std::string name(name_len, '\0');
         in.read(name.data(), static_cast<std::streamsize>(name_len));
 
-        const uint32_t ndim = read_u32(in);
         Tensor tensor;
+        if(version == 2u)
+        {
+            const uint32_t dtype = read_u32(in);
+            if(dtype > 1u)
+                throw std::runtime_error("nardi_infer: unknown element type for tensor '" + name + "'");
+            tensor.is_int8 = dtype == 1u;
+        }
+
+        const uint32_t ndim = read_u32(in);
         tensor.shape.resize(ndim);
         size_t count = 1;
         for(uint32_t d = 0; d < ndim; ++d)
@@ -106,9 +121,17 @@ Blob read_blob(const std::string& path)
             count *= dim;
         }
 
-        tensor.data.resize(count);
-        in.read(reinterpret_cast<char*>(tensor.data.data()),
-                static_cast<std::streamsize>(count * sizeof(float)));
+        if(tensor.is_int8)
+        {
+            tensor.qdata.resize(count);
+            in.read(reinterpret_cast<char*>(tensor.qdata.data()), static_cast<std::streamsize>(count));
+        }
+        else
+        {
+            tensor.data.resize(count);
+            in.read(reinterpret_cast<char*>(tensor.data.data()),
+                    static_cast<std::streamsize>(count * sizeof(float)));
+        }
         if(!in)
             throw std::runtime_error("nardi_infer: truncated tensor '" + name + "'");
 
@@ -118,194 +141,1292 @@ Blob read_blob(const std::string& path)
     return blob;
 }
 
-// ---- feature extraction ------------------------------------------------
-
-void fill_features(const Nardi::Board::Features& f, float* out, ModelKind kind)
+// ---- kernels -------------------------------------------------------------
+//
+// The GEMM, LayerNorm and column-update inner loops, once as portable scalar code (the parity
+// reference) and once per SIMD instruction set, picked at runtime.
+//
+// GEMM: one weight panel (P consecutive output rows stored [K][P]) against rows
+// [m0, m1) of A [M, K], writing outputs 0 .. lanes-1 of the panel to
+// C[m * ldm + j * ldn]. Every output is summed over k in order from its bias,
+// in the same way by the multi-row and single-row paths, so a batch gives the
+// exact values of evaluating one position at a time with the same kernel.
+using PanelKernel = void (*)(const float* A, int m0, int m1, int K, const float* panel,
+                             const float* bias, int lanes, float* C, size_t ldm, size_t ldn);
+
+// LayerNorm over x[0, size), affine. Statistics are accumulated in double.
+using NormKernel = void (*)(float* x, int size, const float* gamma, const float* beta, float eps);
+
+// Int8 GEMM: one panel of Q int8 weight rows, stored [K/2][Q][2] so each
+// 32-bit step multiplies a pair of k, against rows [m0, m1) of int16
+// activations A [M, 2 * pairs]. The int32 sums are exact in every kernel set
+// (QuantWeights keeps them in range); each is dequantized as sum * scale + bias
+// and stored like the float kernels do.
+using QuantKernel = void (*)(const int16_t* A, int m0, int m1, int pairs, const int8_t* panel,
+                             const float* scale, const float* bias, int lanes, float* C,
+                             size_t ldm, size_t ldn);
+
+// y[0, n) += a * x[0, n): one weight column added to a first-layer output when
+// a single input changes (evaluate_siblings).
+using AxpyKernel = void (*)(float* y, const float* x, float a, int n);
+
+struct KernelSet
 {
-    for(int row = 0; row < 3; ++row)
-        for(int col = 0; col < BOARD_COLS; ++col)
-            out[row * FEAT_COLS + col] = static_cast<float>(f.player.occ[row][col]) / FEAT_SCALE;
+    const char* name;
+    int panel;   // output rows per weight panel
+    PanelKernel run;
+    NormKernel layer_norm;
+    int quant_panel;   // output rows per int8 weight panel
+    QuantKernel quant;
+    AxpyKernel axpy;
+};
 
-    for(int row = 0; row < 3; ++row)
-        for(int col = 0; col < BOARD_COLS; ++col)
-            out[(row + 3) * FEAT_COLS + col] = static_cast<float>(f.opp.occ[row][col]) / FEAT_SCALE;
+inline void store_lanes(const float* acc, int lanes, float* c, size_t ldn)
+{
+    for(int j = 0; j < lanes; ++j)
+        c[j * ldn] = acc[j];
+}
 
-    // Legacy uses square-occupancy; conv/res use pip-count (see nardi_net.py).
-    const float third_player = (kind == ModelKind::LEGACY)
-        ? static_cast<float>(f.player.sq_occ)
-        : static_cast<float>(f.player.pip_count);
-    const float third_opp = (kind == ModelKind::LEGACY)
-        ? static_cast<float>(f.opp.sq_occ)
-        : static_cast<float>(f.opp.pip_count);
+// Portable scalar kernel, P = 4 with a 4x4 register block. This is the parity
+// reference: the SIMD kernels below only differ from it by fused multiply-add
+// rounding.
+void panel_reference(const float* A, int m0, int m1, int K, const float* panel,
+                     const float* bias, int lanes, float* C, size_t ldm, size_t ldn)
+{
+    int m = m0;
+    for(; m + 4 <= m1; m += 4)
+    {
+        const float* a0 = A + static_cast<size_t>(m) * K;
+        const float* a1 = a0 + K;
+        const float* a2 = a1 + K;
+        const float* a3 = a2 + K;
+        float acc0[4], acc1[4], acc2[4], acc3[4];
+        for(int j = 0; j < 4; ++j)
+            acc0[j] = acc1[j] = acc2[j] = acc3[j] = bias[j];
+
+        for(int k = 0; k < K; ++k)
+        {
+            const float* w = panel + k * 4;
+            const float x0 = a0[k], x1 = a1[k], x2 = a2[k], x3 = a3[k];
+            for(int j = 0; j < 4; ++j) acc0[j] += w[j] * x0;
+            for(int j = 0; j < 4; ++j) acc1[j] += w[j] * x1;
+            for(int j = 0; j < 4; ++j) acc2[j] += w[j] * x2;
+            for(int j = 0; j < 4; ++j) acc3[j] += w[j] * x3;
+        }
 
-    const float scalars[FEAT_ROWS] = {
-        static_cast<float>(f.player.pieces_off),
-        static_cast<float>(f.opp.pieces_off),
-        third_player,
-        third_opp,
-        static_cast<float>(f.player.pieces_not_reached),
-        static_cast<float>(f.opp.pieces_not_reached)
-    };
-    for(int row = 0; row < FEAT_ROWS; ++row)
-        out[row * FEAT_COLS + (FEAT_COLS - 1)] = scalars[row] / FEAT_SCALE;
+        store_lanes(acc0, lanes, C + (m + 0) * ldm, ldn);
+        store_lanes(acc1, lanes, C + (m + 1) * ldm, ldn);
+        store_lanes(acc2, lanes, C + (m + 2) * ldm, ldn);
+        store_lanes(acc3, lanes, C + (m + 3) * ldm, ldn);
+    }
+    for(; m < m1; ++m)
+    {
+        const float* a = A + static_cast<size_t>(m) * K;
+        float acc[4];
+        for(int j = 0; j < 4; ++j)
+            acc[j] = bias[j];
+        for(int k = 0; k < K; ++k)
+            for(int j = 0; j < 4; ++j)
+                acc[j] += panel[k * 4 + j] * a[k];
+        store_lanes(acc, lanes, C + m * ldm, ldn);
+    }
 }
 
-// ---- layer primitives --------------------------------------------------
-
-// 1D convolution. in is [Cin, L] row-major; weight is [Cout, Cin, K]; bias [Cout].
-// Returns [Cout, Lout] row-major with Lout = (L + 2*pad - K)/stride + 1.
-std::vector<float> conv1d(const float* in, int Cin, int L,
-                          const Tensor& weight, const Tensor& bias,
-                          int stride, int pad)
+inline int32_t load_pair(const int16_t* a)
 {
-    const int Cout = weight.dim(0);
-    const int K = weight.dim(2);
-    const int Lout = (L + 2 * pad - K) / stride + 1;
+    int32_t pair;
+    std::memcpy(&pair, a, sizeof(pair));
+    return pair;
+}
 
-    std::vector<float> out(static_cast<size_t>(Cout) * Lout);
-    for(int oc = 0; oc < Cout; ++oc)
+// Portable int8 kernel, Q = 8.
+void quant_panel_reference(const int16_t* A, int m0, int m1, int pairs, const int8_t* panel,
+                           const float* scale, const float* bias, int lanes, float* C,
+                           size_t ldm, size_t ldn)
+{
+    for(int m = m0; m < m1; ++m)
     {
-        const float b = bias.data[static_cast<size_t>(oc)];
-        for(int ol = 0; ol < Lout; ++ol)
+        const int16_t* a = A + static_cast<size_t>(m) * 2 * pairs;
+        int32_t acc[8] = {};
+        for(int p = 0; p < pairs; ++p)
         {
-            float acc = b;
-            const int start = ol * stride - pad;
-            for(int ic = 0; ic < Cin; ++ic)
-            {
-                const float* in_row = in + static_cast<size_t>(ic) * L;
-                const float* w_row = weight.data.data() +
-                                     ((static_cast<size_t>(oc) * Cin + ic) * K);
-                for(int k = 0; k < K; ++k)
-                {
-                    const int ipos = start + k;
-                    if(ipos < 0 || ipos >= L)
-                        continue;
-                    acc += w_row[k] * in_row[ipos];
-                }
-            }
-            out[static_cast<size_t>(oc) * Lout + ol] = acc;
+            const int8_t* w = panel + p * 16;
+            const int32_t x0 = a[2 * p], x1 = a[2 * p + 1];
+            for(int j = 0; j < 8; ++j)
+                acc[j] += w[2 * j] * x0 + w[2 * j + 1] * x1;
         }
+        for(int j = 0; j < lanes; ++j)
+            C[m * ldm + j * ldn] = static_cast<float>(acc[j]) * scale[j] + bias[j];
     }
-    return out;
 }
 
-// Fully connected: weight [out, in], bias [out].
-std::vector<float> linear(const std::vector<float>& in, const Tensor& weight, const Tensor& bias)
+void axpy_reference(float* y, const float* x, float a, int n)
 {
-    const int out_dim = weight.dim(0);
-    const int in_dim = weight.dim(1);
-    std::vector<float> out(static_cast<size_t>(out_dim));
-    for(int o = 0; o < out_dim; ++o)
-    {
-        float acc = bias.data[static_cast<size_t>(o)];
-        const float* w_row = weight.data.data() + static_cast<size_t>(o) * in_dim;
-        for(int i = 0; i < in_dim; ++i)
-            acc += w_row[i] * in[static_cast<size_t>(i)];
-        out[static_cast<size_t>(o)] = acc;
-    }
-    return out;
+    for(int i = 0; i < n; ++i)
+        y[i] += x[i] * a;
 }
 
-// LayerNorm over the whole vector (normalized_shape == x.size()), affine.
-void layer_norm_inplace(std::vector<float>& x, const Tensor& gamma, const Tensor& beta,
-                        float eps = 1e-5f)
+void layer_norm_reference(float* x, int size, const float* gamma, const float* beta, float eps)
 {
-    const size_t n = x.size();
+    const size_t n = static_cast<size_t>(size);
     double mean = 0.0;
-    for(float v : x)
-        mean += v;
+    for(size_t i = 0; i < n; ++i)
+        mean += x[i];
     mean /= static_cast<double>(n);
 
     double var = 0.0;
-    for(float v : x)
+    for(size_t i = 0; i < n; ++i)
     {
-        const double d = v - mean;
+        const double d = x[i] - mean;
         var += d * d;
     }
     var /= static_cast<double>(n);
 
     const float inv = 1.0f / std::sqrt(static_cast<float>(var) + eps);
     for(size_t i = 0; i < n; ++i)
-        x[i] = (x[i] - static_cast<float>(mean)) * inv * gamma.data[i] + beta.data[i];
+        x[i] = (x[i] - static_cast<float>(mean)) * inv * gamma[i] + beta[i];
 }
 
-void silu_inplace(std::vector<float>& x)
+#if NARDI_INFER_X86
+
+// AVX2 + FMA, P = 8: one ymm of outputs per row, four rows at a time.
+__attribute__((target("avx2,fma")))
+void panel_avx2(const float* A, int m0, int m1, int K, const float* panel,
+                const float* bias, int lanes, float* C, size_t ldm, size_t ldn)
 {
-    for(float& v : x)
-        v = v / (1.0f + std::exp(-v));
+    const __m256 b = _mm256_loadu_ps(bias);
+    alignas(32) float acc[4][8];
+    int m = m0;
+    for(; m + 4 <= m1; m += 4)
+    {
+        const float* a0 = A + static_cast<size_t>(m) * K;
+        const float* a1 = a0 + K;
+        const float* a2 = a1 + K;
+        const float* a3 = a2 + K;
+        __m256 c0 = b, c1 = b, c2 = b, c3 = b;
+        for(int k = 0; k < K; ++k)
+        {
+            const __m256 w = _mm256_loadu_ps(panel + k * 8);
+            c0 = _mm256_fmadd_ps(w, _mm256_set1_ps(a0[k]), c0);
+            c1 = _mm256_fmadd_ps(w, _mm256_set1_ps(a1[k]), c1);
+            c2 = _mm256_fmadd_ps(w, _mm256_set1_ps(a2[k]), c2);
+            c3 = _mm256_fmadd_ps(w, _mm256_set1_ps(a3[k]), c3);
+        }
+        _mm256_store_ps(acc[0], c0);
+        _mm256_store_ps(acc[1], c1);
+        _mm256_store_ps(acc[2], c2);
+        _mm256_store_ps(acc[3], c3);
+        for(int i = 0; i < 4; ++i)
+            store_lanes(acc[i], lanes, C + (m + i) * ldm, ldn);
+    }
+    for(; m < m1; ++m)
+    {
+        const float* a = A + static_cast<size_t>(m) * K;
+        __m256 c = b;
+        for(int k = 0; k < K; ++k)
+            c = _mm256_fmadd_ps(_mm256_loadu_ps(panel + k * 8), _mm256_set1_ps(a[k]), c);
+        _mm256_store_ps(acc[0], c);
+        store_lanes(acc[0], lanes, C + m * ldm, ldn);
+    }
+}
+
+// AVX-512F, P = 16: one zmm of outputs per row, four rows at a time.
+__attribute__((target("avx512f")))
+void panel_avx512(const float* A, int m0, int m1, int K, const float* panel,
+                  const float* bias, int lanes, float* C, size_t ldm, size_t ldn)
+{
+    const __m512 b = _mm512_loadu_ps(bias);
+    alignas(64) float acc[4][16];
+    int m = m0;
+    for(; m + 4 <= m1; m += 4)
+    {
+        const float* a0 = A + static_cast<size_t>(m) * K;
+        const float* a1 = a0 + K;
+        const float* a2 = a1 + K;
+        const float* a3 = a2 + K;
+        __m512 c0 = b, c1 = b, c2 = b, c3 = b;
+        for(int k = 0; k < K; ++k)
+        {
+            const __m512 w = _mm512_loadu_ps(panel + k * 16);
+            c0 = _mm512_fmadd_ps(w, _mm512_set1_ps(a0[k]), c0);
+            c1 = _mm512_fmadd_ps(w, _mm512_set1_ps(a1[k]), c1);
+            c2 = _mm512_fmadd_ps(w, _mm512_set1_ps(a2[k]), c2);
+            c3 = _mm512_fmadd_ps(w, _mm512_set1_ps(a3[k]), c3);
+        }
+        _mm512_store_ps(acc[0], c0);
+        _mm512_store_ps(acc[1], c1);
+        _mm512_store_ps(acc[2], c2);
+        _mm512_store_ps(acc[3], c3);
+        for(int i = 0; i < 4; ++i)
+            store_lanes(acc[i], lanes, C + (m + i) * ldm, ldn);
+    }
+    for(; m < m1; ++m)
+    {
+        const float* a = A + static_cast<size_t>(m) * K;
+        __m512 c = b;
+        for(int k = 0; k < K; ++k)
+            c = _mm512_fmadd_ps(_mm512_loadu_ps(panel + k * 16), _mm512_set1_ps(a[k]), c);
+        _mm512_store_ps(acc[0], c);
+        store_lanes(acc[0], lanes, C + m * ldm, ldn);
+    }
 }
 
-void relu_inplace(std::vector<float>& x)
+__attribute__((target("avx2,fma")))
+void axpy_avx2(float* y, const float* x, float a, int n)
 {
-    for(float& v : x)
-        if(v < 0.0f)
-            v = 0.0f;
+    const __m256 va = _mm256_set1_ps(a);
+    int i = 0;
+    for(; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(y + i, _mm256_fmadd_ps(_mm256_loadu_ps(x + i), va, _mm256_loadu_ps(y + i)));
+    for(; i < n; ++i)
+        y[i] = std::fma(x[i], a, y[i]);
 }
 
-// trunk + value head shared by every architecture: Linear/SiLU/Linear/SiLU/Linear,
-// then softmax over 4 logits weighted by the `scores` buffer (out_dim == 4).
-float trunk_value(std::vector<float> x, const Blob& w)
+__attribute__((target("avx2,fma")))
+void layer_norm_avx2(float* x, int size, const float* gamma, const float* beta, float eps)
+{
+    const int n8 = size & ~7;
+    alignas(32) double part[4];
+
+    __m256d s0 = _mm256_setzero_pd(), s1 = _mm256_setzero_pd();
+    for(int i = 0; i < n8; i += 8)
+    {
+        const __m256 v = _mm256_loadu_ps(x + i);
+        s0 = _mm256_add_pd(s0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        s1 = _mm256_add_pd(s1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+    _mm256_store_pd(part, _mm256_add_pd(s0, s1));
+    double mean = part[0] + part[1] + part[2] + part[3];
+    for(int i = n8; i < size; ++i)
+        mean += x[i];
+    mean /= static_cast<double>(size);
+
+    const __m256d m = _mm256_set1_pd(mean);
+    s0 = _mm256_setzero_pd();
+    s1 = _mm256_setzero_pd();
+    for(int i = 0; i < n8; i += 8)
+    {
+        const __m256 v = _mm256_loadu_ps(x + i);
+        const __m256d d0 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_castps256_ps128(v)), m);
+        const __m256d d1 = _mm256_sub_pd(_mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)), m);
+        s0 = _mm256_fmadd_pd(d0, d0, s0);
+        s1 = _mm256_fmadd_pd(d1, d1, s1);
+    }
+    _mm256_store_pd(part, _mm256_add_pd(s0, s1));
+    double var = part[0] + part[1] + part[2] + part[3];
+    for(int i = n8; i < size; ++i)
+    {
+        const double d = x[i] - mean;
+        var += d * d;
+    }
+    var /= static_cast<double>(size);
+
+    const float inv = 1.0f / std::sqrt(static_cast<float>(var) + eps);
+    const __m256 mf = _mm256_set1_ps(static_cast<float>(mean));
+    const __m256 iv = _mm256_set1_ps(inv);
+    for(int i = 0; i < n8; i += 8)
+    {
+        const __m256 t = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(x + i), mf), iv);
+        _mm256_storeu_ps(x + i, _mm256_fmadd_ps(t, _mm256_loadu_ps(gamma + i), _mm256_loadu_ps(beta + i)));
+    }
+    for(int i = n8; i < size; ++i)
+        x[i] = (x[i] - static_cast<float>(mean)) * inv * gamma[i] + beta[i];
+}
+
+__attribute__((target("avx512f")))
+void axpy_avx512(float* y, const float* x, float a, int n)
+{
+    const __m512 va = _mm512_set1_ps(a);
+    int i = 0;
+    for(; i + 16 <= n; i += 16)
+        _mm512_storeu_ps(y + i, _mm512_fmadd_ps(_mm512_loadu_ps(x + i), va, _mm512_loadu_ps(y + i)));
+    for(; i < n; ++i)
+        y[i] = std::fma(x[i], a, y[i]);
+}
+
+// _mm512_reduce_add_pd's pairwise order, through memory: GCC 12 warns on the
+// undefined passthrough of the extract it expands to.
+__attribute__((target("avx512f")))
+double sum_lanes_avx512(__m512d v)
+{
+    alignas(64) double l[8];
+    _mm512_store_pd(l, v);
+    return ((l[0] + l[4]) + (l[2] + l[6])) + ((l[1] + l[5]) + (l[3] + l[7]));
+}
+
+__attribute__((target("avx512f")))
+void layer_norm_avx512(float* x, int size, const float* gamma, const float* beta, float eps)
+{
+    const int n16 = size & ~15;
+
+    __m512d s0 = _mm512_setzero_pd(), s1 = _mm512_setzero_pd();
+    for(int i = 0; i < n16; i += 16)
+    {
+        // each half widened straight from memory, zero-masked for the same
+        // GCC 12 warning
+        s0 = _mm512_add_pd(s0, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(x + i)));
+        s1 = _mm512_add_pd(s1, _mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(x + i + 8)));
+    }
+    double mean = sum_lanes_avx512(_mm512_add_pd(s0, s1));
+    for(int i = n16; i < size; ++i)
+        mean += x[i];
+    mean /= static_cast<double>(size);
+
+    const __m512d m = _mm512_set1_pd(mean);
+    s0 = _mm512_setzero_pd();
+    s1 = _mm512_setzero_pd();
+    for(int i = 0; i < n16; i += 16)
+    {
+        const __m512d d0 = _mm512_sub_pd(_mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(x + i)), m);
+        const __m512d d1 = _mm512_sub_pd(_mm512_maskz_cvtps_pd(0xFF, _mm256_loadu_ps(x + i + 8)), m);
+        s0 = _mm512_fmadd_pd(d0, d0, s0);
+        s1 = _mm512_fmadd_pd(d1, d1, s1);
+    }
+    double var = sum_lanes_avx512(_mm512_add_pd(s0, s1));
+    for(int i = n16; i < size; ++i)
+    {
+        const double d = x[i] - mean;
+        var += d * d;
+    }
+    var /= static_cast<double>(size);
+
+    const float inv = 1.0f / std::sqrt(static_cast<float>(var) + eps);
+    const __m512 mf = _mm512_set1_ps(static_cast<float>(mean));
+    const __m512 iv = _mm512_set1_ps(inv);
+    for(int i = 0; i < n16; i += 16)
+    {
+        const __m512 t = _mm512_mul_ps(_mm512_sub_ps(_mm512_loadu_ps(x + i), mf), iv);
+        _mm512_storeu_ps(x + i, _mm512_fmadd_ps(t, _mm512_loadu_ps(gamma + i), _mm512_loadu_ps(beta + i)));
+    }
+    for(int i = n16; i < size; ++i)
+        x[i] = (x[i] - static_cast<float>(mean)) * inv * gamma[i] + beta[i];
+}
+
+// Int8 panel on AVX2, Q = 8: the panel's 16 weights for a k pair widen to
+// int16 and vpmaddwd sums both products per output, four rows at a time.
+__attribute__((target("avx2,fma")))
+void quant_panel_avx2(const int16_t* A, int m0, int m1, int pairs, const int8_t* panel,
+                      const float* scale, const float* bias, int lanes, float* C,
+                      size_t ldm, size_t ldn)
+{
+    const size_t K = static_cast<size_t>(pairs) * 2;
+    const __m256 s = _mm256_loadu_ps(scale);
+    const __m256 b = _mm256_loadu_ps(bias);
+    alignas(32) float acc[4][8];
+    int m = m0;
+    for(; m + 4 <= m1; m += 4)
+    {
+        const int16_t* a0 = A + static_cast<size_t>(m) * K;
+        const int16_t* a1 = a0 + K;
+        const int16_t* a2 = a1 + K;
+        const int16_t* a3 = a2 + K;
+        __m256i c0 = _mm256_setzero_si256(), c1 = c0, c2 = c0, c3 = c0;
+        for(int p = 0; p < pairs; ++p)
+        {
+            const __m256i w = _mm256_cvtepi8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(panel + p * 16)));
+            c0 = _mm256_add_epi32(c0, _mm256_madd_epi16(w, _mm256_set1_epi32(load_pair(a0 + 2 * p))));
+            c1 = _mm256_add_epi32(c1, _mm256_madd_epi16(w, _mm256_set1_epi32(load_pair(a1 + 2 * p))));
+            c2 = _mm256_add_epi32(c2, _mm256_madd_epi16(w, _mm256_set1_epi32(load_pair(a2 + 2 * p))));
+            c3 = _mm256_add_epi32(c3, _mm256_madd_epi16(w, _mm256_set1_epi32(load_pair(a3 + 2 * p))));
+        }
+        _mm256_store_ps(acc[0], _mm256_fmadd_ps(_mm256_cvtepi32_ps(c0), s, b));
+        _mm256_store_ps(acc[1], _mm256_fmadd_ps(_mm256_cvtepi32_ps(c1), s, b));
+        _mm256_store_ps(acc[2], _mm256_fmadd_ps(_mm256_cvtepi32_ps(c2), s, b));
+        _mm256_store_ps(acc[3], _mm256_fmadd_ps(_mm256_cvtepi32_ps(c3), s, b));
+        for(int i = 0; i < 4; ++i)
+            store_lanes(acc[i], lanes, C + (m + i) * ldm, ldn);
+    }
+    for(; m < m1; ++m)
+    {
+        const int16_t* a = A + static_cast<size_t>(m) * K;
+        __m256i c = _mm256_setzero_si256();
+        for(int p = 0; p < pairs; ++p)
+        {
+            const __m256i w = _mm256_cvtepi8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(panel + p * 16)));
+            c = _mm256_add_epi32(c, _mm256_madd_epi16(w, _mm256_set1_epi32(load_pair(a + 2 * p))));
+        }
+        _mm256_store_ps(acc[0], _mm256_fmadd_ps(_mm256_cvtepi32_ps(c), s, b));
+        store_lanes(acc[0], lanes, C + m * ldm, ldn);
+    }
+}
+
+// Int8 panel on AVX-512BW, Q = 16: as the AVX2 kernel, one zmm per row.
+__attribute__((target("avx512f,avx512bw")))
+void quant_panel_avx512(const int16_t* A, int m0, int m1, int pairs, const int8_t* panel,
+                        const float* scale, const float* bias, int lanes, float* C,
+                        size_t ldm, size_t ldn)
+{
+    const size_t K = static_cast<size_t>(pairs) * 2;
+    const __m512 s = _mm512_loadu_ps(scale);
+    const __m512 b = _mm512_loadu_ps(bias);
+    alignas(64) float acc[4][16];
+    int m = m0;
+    for(; m + 4 <= m1; m += 4)
+    {
+        const int16_t* a0 = A + static_cast<size_t>(m) * K;
+        const int16_t* a1 = a0 + K;
+        const int16_t* a2 = a1 + K;
+        const int16_t* a3 = a2 + K;
+        __m512i c0 = _mm512_setzero_si512(), c1 = c0, c2 = c0, c3 = c0;
+        for(int p = 0; p < pairs; ++p)
+        {
+            const __m512i w = _mm512_cvtepi8_epi16(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(panel + p * 32)));
+            c0 = _mm512_add_epi32(c0, _mm512_madd_epi16(w, _mm512_set1_epi32(load_pair(a0 + 2 * p))));
+            c1 = _mm512_add_epi32(c1, _mm512_madd_epi16(w, _mm512_set1_epi32(load_pair(a1 + 2 * p))));
+            c2 = _mm512_add_epi32(c2, _mm512_madd_epi16(w, _mm512_set1_epi32(load_pair(a2 + 2 * p))));
+            c3 = _mm512_add_epi32(c3, _mm512_madd_epi16(w, _mm512_set1_epi32(load_pair(a3 + 2 * p))));
+        }
+        // zero-masked converts: GCC 12 warns on the plain one's undefined passthrough
+        _mm512_store_ps(acc[0], _mm512_fmadd_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, c0), s, b));
+        _mm512_store_ps(acc[1], _mm512_fmadd_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, c1), s, b));
+        _mm512_store_ps(acc[2], _mm512_fmadd_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, c2), s, b));
+        _mm512_store_ps(acc[3], _mm512_fmadd_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, c3), s, b));
+        for(int i = 0; i < 4; ++i)
+            store_lanes(acc[i], lanes, C + (m + i) * ldm, ldn);
+    }
+    for(; m < m1; ++m)
+    {
+        const int16_t* a = A + static_cast<size_t>(m) * K;
+        __m512i c = _mm512_setzero_si512();
+        for(int p = 0; p < pairs; ++p)
+        {
+            const __m512i w = _mm512_cvtepi8_epi16(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(panel + p * 32)));
+            c = _mm512_add_epi32(c, _mm512_madd_epi16(w, _mm512_set1_epi32(load_pair(a + 2 * p))));
+        }
+        _mm512_store_ps(acc[0], _mm512_fmadd_ps(_mm512_maskz_cvtepi32_ps(0xFFFF, c), s, b));
+        store_lanes(acc[0], lanes, C + m * ldm, ldn);
+    }
+}
+
+#endif // NARDI_INFER_X86
+
+#if NARDI_INFER_NEON
+
+// NEON (AArch64), P = 4: one q register of outputs per row, four rows at a time.
+void panel_neon(const float* A, int m0, int m1, int K, const float* panel,
+                const float* bias, int lanes, float* C, size_t ldm, size_t ldn)
+{
+    const float32x4_t b = vld1q_f32(bias);
+    float acc[4][4];
+    int m = m0;
+    for(; m + 4 <= m1; m += 4)
+    {
+        const float* a0 = A + static_cast<size_t>(m) * K;
+        const float* a1 = a0 + K;
+        const float* a2 = a1 + K;
+        const float* a3 = a2 + K;
+        float32x4_t c0 = b, c1 = b, c2 = b, c3 = b;
+        for(int k = 0; k < K; ++k)
+        {
+            const float32x4_t w = vld1q_f32(panel + k * 4);
+            c0 = vfmaq_n_f32(c0, w, a0[k]);
+            c1 = vfmaq_n_f32(c1, w, a1[k]);
+            c2 = vfmaq_n_f32(c2, w, a2[k]);
+            c3 = vfmaq_n_f32(c3, w, a3[k]);
+        }
+        vst1q_f32(acc[0], c0);
+        vst1q_f32(acc[1], c1);
+        vst1q_f32(acc[2], c2);
+        vst1q_f32(acc[3], c3);
+        for(int i = 0; i < 4; ++i)
+            store_lanes(acc[i], lanes, C + (m + i) * ldm, ldn);
+    }
+    for(; m < m1; ++m)
+    {
+        const float* a = A + static_cast<size_t>(m) * K;
+        float32x4_t c = b;
+        for(int k = 0; k < K; ++k)
+            c = vfmaq_n_f32(c, vld1q_f32(panel + k * 4), a[k]);
+        vst1q_f32(acc[0], c);
+        store_lanes(acc[0], lanes, C + m * ldm, ldn);
+    }
+}
+
+void axpy_neon(float* y, const float* x, float a, int n)
+{
+    int i = 0;
+    for(; i + 4 <= n; i += 4)
+        vst1q_f32(y + i, vfmaq_n_f32(vld1q_f32(y + i), vld1q_f32(x + i), a));
+    for(; i < n; ++i)
+        y[i] = std::fma(x[i], a, y[i]);
+}
+
+void layer_norm_neon(float* x, int size, const float* gamma, const float* beta, float eps)
+{
+    const int n4 = size & ~3;
+
+    float64x2_t s0 = vdupq_n_f64(0.0), s1 = vdupq_n_f64(0.0);
+    for(int i = 0; i < n4; i += 4)
+    {
+        const float32x4_t v = vld1q_f32(x + i);
+        s0 = vaddq_f64(s0, vcvt_f64_f32(vget_low_f32(v)));
+        s1 = vaddq_f64(s1, vcvt_high_f64_f32(v));
+    }
+    double mean = vaddvq_f64(vaddq_f64(s0, s1));
+    for(int i = n4; i < size; ++i)
+        mean += x[i];
+    mean /= static_cast<double>(size);
+
+    const float64x2_t m = vdupq_n_f64(mean);
+    s0 = vdupq_n_f64(0.0);
+    s1 = vdupq_n_f64(0.0);
+    for(int i = 0; i < n4; i += 4)
+    {
+        const float32x4_t v = vld1q_f32(x + i);
+        const float64x2_t d0 = vsubq_f64(vcvt_f64_f32(vget_low_f32(v)), m);
+        const float64x2_t d1 = vsubq_f64(vcvt_high_f64_f32(v), m);
+        s0 = vfmaq_f64(s0, d0, d0);
+        s1 = vfmaq_f64(s1, d1, d1);
+    }
+    double var = vaddvq_f64(vaddq_f64(s0, s1));
+    for(int i = n4; i < size; ++i)
+    {
+        const double d = x[i] - mean;
+        var += d * d;
+    }
+    var /= static_cast<double>(size);
+
+    const float inv = 1.0f / std::sqrt(static_cast<float>(var) + eps);
+    const float32x4_t mf = vdupq_n_f32(static_cast<float>(mean));
+    for(int i = 0; i < n4; i += 4)
+    {
+        const float32x4_t t = vmulq_n_f32(vsubq_f32(vld1q_f32(x + i), mf), inv);
+        vst1q_f32(x + i, vfmaq_f32(vld1q_f32(beta + i), t, vld1q_f32(gamma + i)));
+    }
+    for(int i = n4; i < size; ++i)
+        x[i] = (x[i] - static_cast<float>(mean)) * inv * gamma[i] + beta[i];
+}
+
+// Int8 panel on NEON, Q = 8: weights widen to int16, vmull takes the products to
+// int32, and vpadd folds each output's pair of products together.
+void quant_panel_neon(const int16_t* A, int m0, int m1, int pairs, const int8_t* panel,
+                      const float* scale, const float* bias, int lanes, float* C,
+                      size_t ldm, size_t ldn)
+{
+    alignas(16) float acc[8];
+    for(int m = m0; m < m1; ++m)
+    {
+        const int16_t* a = A + static_cast<size_t>(m) * 2 * pairs;
+        int32x4_t lo = vdupq_n_s32(0), hi = vdupq_n_s32(0);
+        for(int p = 0; p < pairs; ++p)
+        {
+            const int8x16_t w = vld1q_s8(panel + p * 16);
+            const int16x8_t wl = vmovl_s8(vget_low_s8(w));   // outputs 0-3
+            const int16x8_t wh = vmovl_high_s8(w);           // outputs 4-7
+            const int16x8_t x = vreinterpretq_s16_s32(vdupq_n_s32(load_pair(a + 2 * p)));
+            const int16x4_t x4 = vget_low_s16(x);
+            lo = vaddq_s32(lo, vpaddq_s32(vmull_s16(vget_low_s16(wl), x4), vmull_high_s16(wl, x)));
+            hi = vaddq_s32(hi, vpaddq_s32(vmull_s16(vget_low_s16(wh), x4), vmull_high_s16(wh, x)));
+        }
+        vst1q_f32(acc, vfmaq_f32(vld1q_f32(bias), vcvtq_f32_s32(lo), vld1q_f32(scale)));
+        vst1q_f32(acc + 4, vfmaq_f32(vld1q_f32(bias + 4), vcvtq_f32_s32(hi), vld1q_f32(scale + 4)));
+        store_lanes(acc, lanes, C + m * ldm, ldn);
+    }
+}
+
+#endif // NARDI_INFER_NEON
+
+constexpr KernelSet REFERENCE_KERNELS{"reference", 4, panel_reference, layer_norm_reference,
+                                      8, quant_panel_reference, axpy_reference};
+
+// The widest kernel set this CPU runs, checked once at runtime.
+const KernelSet& simd_kernels()
+{
+    static const KernelSet kernels = []() -> KernelSet
+    {
+#if NARDI_INFER_X86
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f"))
+        {
+            if(__builtin_cpu_supports("avx512bw"))
+                return {"avx512", 16, panel_avx512, layer_norm_avx512, 16, quant_panel_avx512, axpy_avx512};
+            return {"avx512", 16, panel_avx512, layer_norm_avx512, 8, quant_panel_avx2, axpy_avx512};
+        }
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return {"avx2", 8, panel_avx2, layer_norm_avx2, 8, quant_panel_avx2, axpy_avx2};
+#elif NARDI_INFER_NEON
+        return {"neon", 4, panel_neon, layer_norm_neon, 8, quant_panel_neon, axpy_neon};
+#endif
+        return REFERENCE_KERNELS;
+    }();
+    return kernels;
+}
+
+std::atomic<bool> use_reference_kernels{false};
+
+const KernelSet& active_kernels()
+{
+    return use_reference_kernels.load(std::memory_order_relaxed) ? REFERENCE_KERNELS : simd_kernels();
+}
+
+// A weight matrix [N, K] plus bias [N], packed for the kernel set active when
+// it was built: panel p holds rows pP..pP+P-1 as [K][P]. The last panel is
+// zero-padded; its padding lanes are computed but never stored.
+struct PackedWeights
+{
+    int rows = 0;   // N
+    int cols = 0;   // K
+    const KernelSet* kernels = &REFERENCE_KERNELS;
+    std::vector<float> panels;
+    std::vector<float> bias;
+
+    PackedWeights() = default;
+    PackedWeights(const std::vector<float>& w, const std::vector<float>& b, int n, int k)
+        : rows(n), cols(k), kernels(&active_kernels())
+    {
+        const int P = kernels->panel;
+        const int n_panels = (n + P - 1) / P;
+        panels.assign(static_cast<size_t>(n_panels) * P * k, 0.0f);
+        bias.assign(static_cast<size_t>(n_panels) * P, 0.0f);
+        for(int r = 0; r < n; ++r)
+        {
+            float* panel = panels.data() + static_cast<size_t>(r / P) * P * k;
+            for(int c = 0; c < k; ++c)
+                panel[static_cast<size_t>(c) * P + r % P] = w[static_cast<size_t>(r) * k + c];
+            bias[static_cast<size_t>(r)] = b[static_cast<size_t>(r)];
+        }
+    }
+
+    float at(int r, int c) const
+    {
+        const int P = kernels->panel;
+        return panels[static_cast<size_t>(r / P) * P * cols + static_cast<size_t>(c) * P + r % P];
+    }
+};
+
+// C = A * W^T + bias, with A [M, K] row-major and W packed as above. Element
+// (m, n) is stored at C[m * ldm + n * ldn], so the same kernel writes row-major
+// activations and channel-major conv output. Tiled so an A block and a few
+// weight panels share L1/L2.
+void gemm_bias(const float* A, int M, const PackedWeights& W, float* C, size_t ldm, size_t ldn)
+{
+    constexpr int M_TILE = 64;
+    constexpr int N_TILE = 16;   // a multiple of every panel width
+    const int N = W.rows;
+    const int K = W.cols;
+    const int P = W.kernels->panel;
+
+    for(int n0 = 0; n0 < N; n0 += N_TILE)
+    {
+        const int n1 = std::min(N, n0 + N_TILE);
+        for(int m0 = 0; m0 < M; m0 += M_TILE)
+        {
+            const int m1 = std::min(M, m0 + M_TILE);
+            for(int n = n0; n < n1; n += P)
+                W.kernels->run(A, m0, m1, K, W.panels.data() + static_cast<size_t>(n) * K,
+                              W.bias.data() + n, std::min(P, N - n), C + n * ldn, ldm, ldn);
+        }
+    }
+}
+
+// ---- layers --------------------------------------------------------------
+//
+// Each layer is bound once at load: its tensors are looked up by name, their
+// shapes checked, and the data copied into the layer. forward() then runs on
+// raw pointers into a caller-provided workspace, over a batch of rows at once.
+
+// Any element type; float-only tensors go through tensor_of_rank.
+const Tensor& weight_of_rank(const Blob& w, const std::string& name, size_t rank)
+{
+    const Tensor& t = w.at(name);
+    if(t.shape.size() != rank)
+        throw std::runtime_error("nardi_infer: weight tensor '" + name + "' has the wrong rank");
+    return t;
+}
+
+const Tensor& tensor_of_rank(const Blob& w, const std::string& name, size_t rank)
+{
+    const Tensor& t = weight_of_rank(w, name, rank);
+    if(t.is_int8)
+        throw std::runtime_error("nardi_infer: weight tensor '" + name + "' must be float32");
+    return t;
+}
+
+// An int8 weight matrix [N, K] exported with one scale per output row
+// (<prefix>.weight_scale) and the largest input magnitude seen in calibration
+// (<prefix>.input_range). Inputs are quantized to int16 over that range, with
+// as many levels as keep K products of an int8 weight in an int32 sum.
+// Packed for the kernel set active when it was built, as panels of Q rows with
+// k pairs interleaved (see QuantKernel); K is padded to an even count and the
+// last panel to Q rows with zero weights.
+struct QuantWeights
+{
+    int rows = 0;    // N
+    int cols = 0;    // K
+    int pairs = 0;   // ceil(K / 2)
+    float levels = 0.0f;            // largest quantized input magnitude
+    float inv_input_scale = 1.0f;   // levels / input_range
+    const KernelSet* kernels = &REFERENCE_KERNELS;
+    std::vector<int8_t> panels;
+    std::vector<float> scale;   // input_scale * weight_scale, per output; padded like bias
+    std::vector<float> bias;
+
+    QuantWeights() = default;
+    QuantWeights(const Blob& w, const std::string& prefix, const Tensor& weight,
+                 const std::vector<float>& b, int n, int k)
+        : rows(n), cols(k), pairs((k + 1) / 2), kernels(&active_kernels())
+    {
+        const Tensor& weight_scale = tensor_of_rank(w, prefix + ".weight_scale", 1);
+        const Tensor& input_range = tensor_of_rank(w, prefix + ".input_range", 1);
+        if(weight_scale.dim(0) != n || input_range.dim(0) != 1 || !(input_range.data[0] > 0.0f))
+            throw std::runtime_error("nardi_infer: bad quantization scales for '" + prefix + "'");
+
+        // |weight| <= 128, so K products stay within int32 at K * 128 * levels
+        const int64_t max_sum = std::numeric_limits<int32_t>::max();
+        levels = static_cast<float>(std::min<int64_t>(std::numeric_limits<int16_t>::max(),
+                                                      max_sum / (128 * 2 * static_cast<int64_t>(pairs))));
+        const float input_scale = input_range.data[0] / levels;
+        inv_input_scale = levels / input_range.data[0];
+
+        const int Q = kernels->quant_panel;
+        const int n_panels = (n + Q - 1) / Q;
+        panels.assign(static_cast<size_t>(n_panels) * panel_size(), 0);
+        scale.assign(static_cast<size_t>(n_panels) * Q, 0.0f);
+        bias.assign(static_cast<size_t>(n_panels) * Q, 0.0f);
+        std::copy(b.begin(), b.end(), bias.begin());
+        for(int r = 0; r < n; ++r)
+        {
+            int8_t* panel = panels.data() + static_cast<size_t>(r / Q) * panel_size();
+            for(int c = 0; c < k; ++c)
+                panel[static_cast<size_t>(c / 2) * 2 * Q + (r % Q) * 2 + c % 2] =
+                    weight.qdata[static_cast<size_t>(r) * k + c];
+            scale[static_cast<size_t>(r)] = input_scale * weight_scale.data[static_cast<size_t>(r)];
+        }
+    }
+
+    int padded_cols() const { return 2 * pairs; }
+    size_t panel_size() const { return static_cast<size_t>(pairs) * 2 * kernels->quant_panel; }
+
+    // Weight (r, c) dequantized: what one quantized input level adds to output r.
+    float at(int r, int c) const
+    {
+        const int Q = kernels->quant_panel;
+        const int8_t q = panels[static_cast<size_t>(r / Q) * panel_size() + static_cast<size_t>(c / 2) * 2 * Q
+                                + (r % Q) * 2 + c % 2];
+        return static_cast<float>(q) * scale[static_cast<size_t>(r)];
+    }
+};
+
+// Activations enter an int8 layer as int16: x scaled to the layer's levels,
+// saturated at the calibrated range and rounded half away from zero (a form
+// the compiler vectorizes, unlike lrint).
+inline int16_t quantize(float x, const QuantWeights& W)
+{
+    const float v = std::clamp(x * W.inv_input_scale, -W.levels, W.levels);
+    return static_cast<int16_t>(static_cast<int32_t>(v + (v < 0.0f ? -0.5f : 0.5f)));
+}
+
+// How far input x_old -> x moves a layer in units of its weights: the change in
+// the quantized input for an int8 layer (W bound), else the plain difference.
+inline float input_change(float x, float x_old, const QuantWeights& W)
+{
+    if(W.rows == 0)
+        return x - x_old;
+    return static_cast<float>(quantize(x, W) - quantize(x_old, W));
+}
+
+// This thread's quantized activations, grown like thread_workspace. Each int8
+// layer uses it only for the duration of its own forward().
+int16_t* thread_quant_workspace(size_t values)
+{
+    thread_local std::vector<int16_t> ws;
+    if(ws.size() < values)
+        ws.resize(values);
+    return ws.data();
+}
+
+// C = dequantize(A * W^T) + bias, with A [M, W.padded_cols()] quantized
+// activations. Strides as in gemm_bias.
+void gemm_quant(const int16_t* A, int M, const QuantWeights& W, float* C, size_t ldm, size_t ldn)
+{
+    constexpr int M_TILE = 64;
+    constexpr int N_TILE = 16;   // a multiple of every int8 panel width
+    const int N = W.rows;
+    const int Q = W.kernels->quant_panel;
+
+    for(int n0 = 0; n0 < N; n0 += N_TILE)
+    {
+        const int n1 = std::min(N, n0 + N_TILE);
+        for(int m0 = 0; m0 < M; m0 += M_TILE)
+        {
+            const int m1 = std::min(M, m0 + M_TILE);
+            for(int n = n0; n < n1; n += Q)
+                W.kernels->quant(A, m0, m1, W.pairs, W.panels.data() + static_cast<size_t>(n / Q) * W.panel_size(),
+                                 W.scale.data() + n, W.bias.data() + n, std::min(Q, N - n),
+                                 C + n * ldn, ldm, ldn);
+        }
+    }
+}
+
+// Fully connected: weight [out, in], bias [out]. An int8 weight binds the
+// layer to its quantized form.
+struct Linear
 {
-    auto h = linear(x, w.at("trunk.0.weight"), w.at("trunk.0.bias"));
-    silu_inplace(h);
-    h = linear(h, w.at("trunk.3.weight"), w.at("trunk.3.bias"));
-    silu_inplace(h);
-    auto logits = linear(h, w.at("trunk.6.weight"), w.at("trunk.6.bias"));
+    int in_dim = 0;
+    int out_dim = 0;
+    PackedWeights weights;
+    QuantWeights qweights;
+    std::vector<float> columns;   // [in_dim][out_dim], see bind_columns()
+
+    Linear() = default;
+    Linear(const Blob& w, const std::string& prefix)
+    {
+        const Tensor& wt = weight_of_rank(w, prefix + ".weight", 2);
+        const Tensor& bt = tensor_of_rank(w, prefix + ".bias", 1);
+        if(bt.dim(0) != wt.dim(0))
+            throw std::runtime_error("nardi_infer: bias size mismatch for '" + prefix + "'");
+        out_dim = wt.dim(0);
+        in_dim = wt.dim(1);
+        if(wt.is_int8)
+            qweights = QuantWeights(w, prefix, wt, bt.data, out_dim, in_dim);
+        else
+            weights = PackedWeights(wt.data, bt.data, out_dim, in_dim);
+    }
+
+    bool quantized() const { return qweights.rows != 0; }
+
+    // in is [rows, in_dim], out [rows, out_dim].
+    void forward(const float* in, int rows, float* out) const
+    {
+        if(!quantized())
+        {
+            gemm_bias(in, rows, weights, out, static_cast<size_t>(out_dim), 1);
+            return;
+        }
 
-    const Tensor& scores = w.at("scores");
-    if(static_cast<int>(logits.size()) != scores.dim(0))
-        throw std::runtime_error("nardi_infer: out_dim != scores size (expected weighted-value head)");
+        const int stride = qweights.padded_cols();
+        int16_t* q = thread_quant_workspace(static_cast<size_t>(rows) * stride);
+        for(int r = 0; r < rows; ++r)
+        {
+            const float* x = in + static_cast<size_t>(r) * in_dim;
+            int16_t* qx = q + static_cast<size_t>(r) * stride;
+            for(int i = 0; i < in_dim; ++i)
+                qx[i] = quantize(x[i], qweights);
+            std::fill(qx + in_dim, qx + stride, int16_t{0});
+        }
+        gemm_quant(q, rows, qweights, out, static_cast<size_t>(out_dim), 1);
+    }
 
-    float max_logit = logits[0];
-    for(float v : logits)
-        if(v > max_logit)
-            max_logit = v;
+    // Copy the weights out column by column for add_input(); done only for a
+    // net's first layer.
+    void bind_columns()
+    {
+        columns.resize(static_cast<size_t>(in_dim) * out_dim);
+        for(int i = 0; i < in_dim; ++i)
+            for(int n = 0; n < out_dim; ++n)
+                columns[static_cast<size_t>(i) * out_dim + n] =
+                    quantized() ? qweights.at(n, i) : weights.at(n, i);
+    }
 
-    double total = 0.0;
-    std::vector<double> probs(logits.size());
-    for(size_t i = 0; i < logits.size(); ++i)
+    // One row of forward() output, updated in place for input i changing from
+    // x_old to x.
+    void add_input(float* out, int i, float x, float x_old) const
     {
-        probs[i] = std::exp(static_cast<double>(logits[i] - max_logit));
-        total += probs[i];
+        const KernelSet* kernels = quantized() ? qweights.kernels : weights.kernels;
+        kernels->axpy(out, columns.data() + static_cast<size_t>(i) * out_dim,
+                      input_change(x, x_old, qweights), out_dim);
     }
+};
 
-    double value = 0.0;
-    for(size_t i = 0; i < probs.size(); ++i)
-        value += (probs[i] / total) * static_cast<double>(scores.data[i]);
+// 1D convolution, stride 1, as im2col + GEMM. weight is [Cout, Cin, K]; bias [Cout].
+// An int8 weight binds the layer to its quantized form.
+struct Conv1d
+{
+    int in_channels = 0;
+    int out_channels = 0;
+    int kernel = 0;
+    int pad = 0;
+    PackedWeights weights;   // [Cout, Cin * K]
+    QuantWeights qweights;
+    std::vector<float> columns;   // [Cin * K][Cout], see bind_columns()
+
+    Conv1d() = default;
+    Conv1d(const Blob& w, const std::string& prefix, int padding) : pad(padding)
+    {
+        const Tensor& wt = weight_of_rank(w, prefix + ".weight", 3);
+        const Tensor& bt = tensor_of_rank(w, prefix + ".bias", 1);
+        if(bt.dim(0) != wt.dim(0))
+            throw std::runtime_error("nardi_infer: bias size mismatch for '" + prefix + "'");
+        out_channels = wt.dim(0);
+        in_channels = wt.dim(1);
+        kernel = wt.dim(2);
+        if(wt.is_int8)
+            qweights = QuantWeights(w, prefix, wt, bt.data, out_channels, in_channels * kernel);
+        else
+            weights = PackedWeights(wt.data, bt.data, out_channels, in_channels * kernel);
+    }
+
+    bool quantized() const { return qweights.rows != 0; }
+    int out_len(int L) const { return L + 2 * pad - kernel + 1; }
+
+    // Scratch per row of forward(): its patches, unless a quantized layer
+    // unrolls them into its int16 workspace, and its position-major output.
+    size_t cols_size(int L) const
+    {
+        return static_cast<size_t>(out_len(L)) * ((quantized() ? 0 : in_channels * kernel) + out_channels);
+    }
+
+    // `rows` inputs [Cin, L] row-major, in_stride floats apart, to as many
+    // [Cout, out_len(L)] outputs out_stride apart. The patches of every row go
+    // through one GEMM; cols is rows * cols_size(L) floats of scratch.
+    void forward(const float* in, int rows, int L, size_t in_stride,
+                 float* out, size_t out_stride, float* cols) const
+    {
+        const int Lout = out_len(L);
+        const int M = rows * Lout;
+        float* y = cols;   // [M, Cout]
+        if(!quantized())
+        {
+            const int patch = in_channels * kernel;
+            float* patches = y + static_cast<size_t>(M) * out_channels;
+            for(int r = 0; r < rows; ++r)
+                im2col(in + r * in_stride, L, patches + static_cast<size_t>(r) * Lout * patch, patch);
+            gemm_bias(patches, M, weights, y, static_cast<size_t>(out_channels), 1);
+        }
+        else
+        {
+            const int stride = qweights.padded_cols();
+            const size_t in_size = static_cast<size_t>(in_channels) * L;
+            int16_t* q = thread_quant_workspace(in_size + static_cast<size_t>(M) * stride);
+            int16_t* patches = q + in_size;
+            for(int r = 0; r < rows; ++r)
+            {
+                const float* row = in + r * in_stride;
+                for(size_t i = 0; i < in_size; ++i)
+                    q[i] = quantize(row[i], qweights);
+                im2col(q, L, patches + static_cast<size_t>(r) * Lout * stride, stride);
+            }
+            gemm_quant(patches, M, qweights, y, static_cast<size_t>(out_channels), 1);
+        }
+
+        // back to channel-major, one row at a time
+        for(int r = 0; r < rows; ++r)
+        {
+            const float* src = y + static_cast<size_t>(r) * Lout * out_channels;
+            float* dst = out + r * out_stride;
+            for(int oc = 0; oc < out_channels; ++oc)
+                for(int l = 0; l < Lout; ++l)
+                    dst[static_cast<size_t>(oc) * Lout + l] = src[static_cast<size_t>(l) * out_channels + oc];
+        }
+    }
+
+    // Copy the weights out tap by tap for add_input(); done only for a net's
+    // first layer.
+    void bind_columns()
+    {
+        const int patch = in_channels * kernel;
+        columns.resize(static_cast<size_t>(patch) * out_channels);
+        for(int c = 0; c < patch; ++c)
+            for(int oc = 0; oc < out_channels; ++oc)
+                columns[static_cast<size_t>(c) * out_channels + oc] =
+                    quantized() ? qweights.at(oc, c) : weights.at(oc, c);
+    }
+
+    // forward() output over an input of length L, updated in place for
+    // in[ic][p] changing from x_old to x: each tap k moves output p + pad - k.
+    void add_input(float* out, int L, int ic, int p, float x, float x_old) const
+    {
+        const int Lout = out_len(L);
+        const float d = input_change(x, x_old, qweights);
+        for(int k = 0; k < kernel; ++k)
+        {
+            const int l = p + pad - k;
+            if(l < 0 || l >= Lout)
+                continue;
+            const float* col = columns.data() + static_cast<size_t>(ic * kernel + k) * out_channels;
+            for(int oc = 0; oc < out_channels; ++oc)
+                out[static_cast<size_t>(oc) * Lout + l] += col[oc] * d;
+        }
+    }
 
-    return static_cast<float>(value);
+private:
+    // Patch l holds in[ic][l - pad + k] at ic * K + k, zero in the padding and
+    // up to `stride`; the zero taps add nothing, so sums match a direct
+    // convolution.
+    template <typename T>
+    void im2col(const T* in, int L, T* cols, int stride) const
+    {
+        const int Lout = out_len(L);
+        const int patch = in_channels * kernel;
+        for(int ol = 0; ol < Lout; ++ol)
+        {
+            T* col = cols + static_cast<size_t>(ol) * stride;
+            const int start = ol - pad;
+            const int k_lo = std::clamp(-start, 0, kernel);
+            const int k_hi = std::clamp(L - start, k_lo, kernel);
+            for(int ic = 0; ic < in_channels; ++ic)
+            {
+                const T* in_row = in + static_cast<size_t>(ic) * L;
+                T* dst = col + ic * kernel;
+                std::fill(dst, dst + k_lo, T{0});
+                std::copy(in_row + start + k_lo, in_row + start + k_hi, dst + k_lo);
+                std::fill(dst + k_hi, dst + kernel, T{0});
+            }
+            std::fill(col + patch, col + stride, T{0});
+        }
+    }
+};
+
+// LayerNorm over the whole vector (normalized_shape == size), affine.
+struct LayerNorm
+{
+    int size = 0;
+    const KernelSet* kernels = &REFERENCE_KERNELS;
+    std::vector<float> gamma;
+    std::vector<float> beta;
+
+    LayerNorm() = default;
+    LayerNorm(const Blob& w, const std::string& prefix) : kernels(&active_kernels())
+    {
+        const Tensor& g = tensor_of_rank(w, prefix + ".weight", 1);
+        const Tensor& b = tensor_of_rank(w, prefix + ".bias", 1);
+        if(b.dim(0) != g.dim(0))
+            throw std::runtime_error("nardi_infer: LayerNorm size mismatch for '" + prefix + "'");
+        size = g.dim(0);
+        gamma = g.data;
+        beta = b.data;
+    }
+
+    void forward(float* x, float eps = 1e-5f) const
+    {
+        kernels->layer_norm(x, size, gamma.data(), beta.data(), eps);
+    }
+};
+
+void silu_inplace(float* x, size_t n)
+{
+    for(size_t i = 0; i < n; ++i)
+        x[i] = x[i] / (1.0f + std::exp(-x[i]));
+}
+
+void relu_inplace(float* x, size_t n)
+{
+    for(size_t i = 0; i < n; ++i)
+        if(x[i] < 0.0f)
+            x[i] = 0.0f;
+}
+
+// trunk + value head shared by every architecture: Linear/SiLU/Linear/SiLU/Linear,
+// then softmax over the logits weighted by the `scores` buffer.
+struct Trunk
+{
+    Linear fc0;
+    Linear fc1;
+    Linear head;
+    std::vector<float> scores;
+
+    explicit Trunk(const Blob& w)
+        : fc0(w, "trunk.0"), fc1(w, "trunk.3"), head(w, "trunk.6"),
+          scores(tensor_of_rank(w, "scores", 1).data)
+    {
+        if(fc1.in_dim != fc0.out_dim || head.in_dim != fc1.out_dim)
+            throw std::runtime_error("nardi_infer: trunk layer sizes do not chain");
+        if(head.out_dim != static_cast<int>(scores.size()))
+            throw std::runtime_error("nardi_infer: out_dim != scores size (expected weighted-value head)");
+    }
+
+    int in_dim() const { return fc0.in_dim; }
+    size_t workspace_size(int rows) const
+    {
+        return static_cast<size_t>(rows) * (fc0.out_dim + fc1.out_dim + head.out_dim);
+    }
+
+    // x is [rows, in_dim()]; ws at least workspace_size(rows) floats; one value
+    // per row into out.
+    void value(const float* x, int rows, float* ws, float* out) const
+    {
+        float* h0 = ws;
+        fc0.forward(x, rows, h0);
+        value_from(h0, rows, h0 + static_cast<size_t>(rows) * fc0.out_dim, out);
+    }
+
+    // The rest of value() from fc0's output h0 [rows, fc0.out_dim], which is
+    // activated in place; ws is the workspace past h0.
+    void value_from(float* h0, int rows, float* ws, float* out) const
+    {
+        float* h1 = ws;
+        float* logits = h1 + static_cast<size_t>(rows) * fc1.out_dim;
+
+        silu_inplace(h0, static_cast<size_t>(rows) * fc0.out_dim);
+        fc1.forward(h0, rows, h1);
+        silu_inplace(h1, static_cast<size_t>(rows) * fc1.out_dim);
+        head.forward(h1, rows, logits);
+
+        const int n = head.out_dim;
+        for(int r = 0; r < rows; ++r)
+        {
+            const float* lg = logits + static_cast<size_t>(r) * n;
+            float max_logit = lg[0];
+            for(int i = 0; i < n; ++i)
+                if(lg[i] > max_logit)
+                    max_logit = lg[i];
+
+            // exp is recomputed in the second pass rather than kept in a buffer.
+            double total = 0.0;
+            for(int i = 0; i < n; ++i)
+                total += std::exp(static_cast<double>(lg[i] - max_logit));
+
+            double value = 0.0;
+            for(int i = 0; i < n; ++i)
+                value += (std::exp(static_cast<double>(lg[i] - max_logit)) / total) *
+                         static_cast<double>(scores[static_cast<size_t>(i)]);
+
+            out[r] = static_cast<float>(value);
+        }
+    }
+};
+
+// The 6 trailing scalars of a filled [6, 25] feature block.
+void copy_scalars(const float* feat, float* scalars)
+{
+    for(int c = 0; c < FEATURE_ROWS; ++c)
+        scalars[c] = feat[c * FEATURE_COLS + (FEATURE_COLS - 1)];
 }
 
 // Split a filled [6, 25] feature block into the [6, 24] board (channel-major)
 // and the 6 trailing scalars.
-void split_board_scalars(const float* feat, std::vector<float>& board, float scalars[FEAT_ROWS])
+void split_board_scalars(const float* feat, float* board, float* scalars)
 {
-    board.resize(static_cast<size_t>(FEAT_ROWS) * BOARD_COLS);
-    for(int c = 0; c < FEAT_ROWS; ++c)
-    {
+    for(int c = 0; c < FEATURE_ROWS; ++c)
         for(int p = 0; p < BOARD_COLS; ++p)
-            board[static_cast<size_t>(c) * BOARD_COLS + p] = feat[c * FEAT_COLS + p];
-        scalars[c] = feat[c * FEAT_COLS + (FEAT_COLS - 1)];
-    }
+            board[c * BOARD_COLS + p] = feat[c * FEATURE_COLS + p];
+    copy_scalars(feat, scalars);
+}
+
+// This thread's forward() scratch, grown to the largest size asked for; once a
+// net has run on a thread its forward allocates nothing.
+float* thread_workspace(size_t floats)
+{
+    thread_local std::vector<float> ws;
+    if(ws.size() < floats)
+        ws.resize(floats);
+    return ws.data();
 }
 
 // ---- concrete networks -------------------------------------------------
 
+// Derived supplies PIPELINE (its input layout), workspace_size(rows) and
+// forward(feat, rows, ws, out) over `rows` written feature blocks. Single
+// positions run as a batch of one, so both paths give the same values.
+//
+// For evaluate_siblings it also exposes its first layer, the one linear in the
+// feature block: accumulator_size() outputs per row, accumulate(feat, acc, ws)
+// over one block, add_input(acc, cell, x, x_old) for one feature cell changing,
+// and forward_from(feat, accs, rows, ws, out) running the rest of forward() on
+// `rows` first-layer outputs (consumed in place).
 template <typename Derived>
 class NetBase : public InferenceNet
 {
 public:
+    // Rows per forward call: big enough to fill the GEMM tiles, small enough
+    // that the activations stay in cache.
+    static constexpr int BATCH_ROWS = 256;
+
     float evaluate(const Nardi::Board::Features& f) const override
     {
-        return static_cast<const Derived*>(this)->forward(f);
+        float* feat = thread_workspace(FEATURE_SIZE + derived().workspace_size(1));
+        write_features(f, Derived::PIPELINE, feat);
+        float value;
+        derived().forward(feat, 1, feat + FEATURE_SIZE, &value);
+        return value;
+    }
+
+    float evaluate(const Nardi::Board& board, bool side) const override
+    {
+        float* feat = thread_workspace(FEATURE_SIZE + derived().workspace_size(1));
+        write_features(board, side, Derived::PIPELINE, feat);
+        float value;
+        derived().forward(feat, 1, feat + FEATURE_SIZE, &value);
+        return value;
     }
 
     std::vector<float> evaluate_batch(
         const std::vector<Nardi::Board::Features>& features) const override
     {
-        std::vector<float> out(features.size());
-        for(size_t i = 0; i < features.size(); ++i)
-            out[i] = static_cast<const Derived*>(this)->forward(features[i]);
+        return run_batch(features);
+    }
+
+    std::vector<float> evaluate_batch(const std::vector<EvalPosition>& positions) const override
+    {
+        return run_batch(positions);
+    }
+
+    std::vector<float> evaluate_siblings(const Nardi::Board::Features& parent,
+                                         const std::vector<Nardi::Board::Features>& features) const override
+    {
+        return run_siblings(parent, features);
+    }
+
+    std::vector<float> evaluate_siblings(const EvalPosition& parent,
+                                         const std::vector<EvalPosition>& positions) const override
+    {
+        return run_siblings(parent, positions);
+    }
+
+private:
+    const Derived& derived() const { return *static_cast<const Derived*>(this); }
+
+    // Packs BATCH_ROWS positions at a time into an [n, 150] block and runs
+    // every layer over the block.
+    template <typename Position>
+    std::vector<float> run_batch(const std::vector<Position>& positions) const
+    {
+        std::vector<float> out(positions.size());
+        const size_t feat_size = static_cast<size_t>(BATCH_ROWS) * FEATURE_SIZE;
+        float* feat = thread_workspace(feat_size + derived().workspace_size(BATCH_ROWS));
+        for(size_t begin = 0; begin < positions.size(); begin += BATCH_ROWS)
+        {
+            const int rows = static_cast<int>(std::min<size_t>(BATCH_ROWS, positions.size() - begin));
+            for(int r = 0; r < rows; ++r)
+                write_features(positions[begin + static_cast<size_t>(r)], Derived::PIPELINE,
+                               feat + static_cast<size_t>(r) * FEATURE_SIZE);
+            derived().forward(feat, rows, feat + feat_size, out.data() + begin);
+        }
+        return out;
+    }
+
+    // run_batch with the first layer carried over from `parent`: it runs once
+    // on the parent's block, and each row starts from that output plus the
+    // columns of the cells where its block differs.
+    template <typename Position>
+    std::vector<float> run_siblings(const Position& parent, const std::vector<Position>& positions) const
+    {
+        std::vector<float> out(positions.size());
+        if(positions.empty())
+            return out;
+
+        // BATCH_ROWS blocks, then the parent's; the same for first-layer outputs
+        const size_t acc_size = derived().accumulator_size();
+        const size_t feat_size = static_cast<size_t>(BATCH_ROWS + 1) * FEATURE_SIZE;
+        const size_t accs_size = static_cast<size_t>(BATCH_ROWS + 1) * acc_size;
+        float* feat = thread_workspace(feat_size + accs_size + derived().workspace_size(BATCH_ROWS));
+        float* accs = feat + feat_size;
+        float* ws = accs + accs_size;
+
+        const float* parent_feat = feat + static_cast<size_t>(BATCH_ROWS) * FEATURE_SIZE;
+        const float* parent_acc = accs + static_cast<size_t>(BATCH_ROWS) * acc_size;
+        write_features(parent, Derived::PIPELINE, feat + static_cast<size_t>(BATCH_ROWS) * FEATURE_SIZE);
+        derived().accumulate(parent_feat, accs + static_cast<size_t>(BATCH_ROWS) * acc_size, ws);
+
+        for(size_t begin = 0; begin < positions.size(); begin += BATCH_ROWS)
+        {
+            const int rows = static_cast<int>(std::min<size_t>(BATCH_ROWS, positions.size() - begin));
+            for(int r = 0; r < rows; ++r)
+            {
+                float* f = feat + static_cast<size_t>(r) * FEATURE_SIZE;
+                float* acc = accs + static_cast<size_t>(r) * acc_size;
+                write_features(positions[begin + static_cast<size_t>(r)], Derived::PIPELINE, f);
+                std::copy(parent_acc, parent_acc + acc_size, acc);
+                for(int cell = 0; cell < FEATURE_SIZE; ++cell)
+                    if(f[cell] != parent_feat[cell])
+                        derived().add_input(acc, cell, f[cell], parent_feat[cell]);
+            }
+            derived().forward_from(feat, accs, rows, ws, out.data() + begin);
+        }
         return out;
     }
 };
@@ -314,18 +1435,42 @@ public:
 class MlpNet : public NetBase<MlpNet>
 {
 public:
-    explicit MlpNet(Blob blob) : _w(std::move(blob)) {}
+    static constexpr FeaturePipelineKind PIPELINE = FeaturePipelineKind::LEGACY;
 
-    float forward(const Nardi::Board::Features& f) const
+    explicit MlpNet(const Blob& w) : _trunk(w)
     {
-        float feat[FEAT_ROWS * FEAT_COLS];
-        fill_features(f, feat, ModelKind::LEGACY);
-        std::vector<float> x(feat, feat + FEAT_ROWS * FEAT_COLS);
-        return trunk_value(std::move(x), _w);
+        if(_trunk.in_dim() != FEATURE_SIZE)
+            throw std::runtime_error("nardi_infer: MLP trunk input is not the feature size");
+        _trunk.fc0.bind_columns();
+    }
+
+    size_t workspace_size(int rows) const { return _trunk.workspace_size(rows); }
+
+    void forward(const float* feat, int rows, float* ws, float* out) const
+    {
+        _trunk.value(feat, rows, ws, out);
+    }
+
+    // first layer: trunk.0 over the flat block
+    size_t accumulator_size() const { return static_cast<size_t>(_trunk.fc0.out_dim); }
+
+    void accumulate(const float* feat, float* acc, float* /*ws*/) const
+    {
+        _trunk.fc0.forward(feat, 1, acc);
+    }
+
+    void add_input(float* acc, int cell, float x, float x_old) const
+    {
+        _trunk.fc0.add_input(acc, cell, x, x_old);
+    }
+
+    void forward_from(const float* /*feat*/, float* accs, int rows, float* ws, float* out) const
+    {
+        _trunk.value_from(accs, rows, ws, out);
     }
 
 private:
-    Blob _w;
+    Trunk _trunk;
 };
 
 // ConvNardiNet: Conv1d(6->C, k=5) [+ ReLU + Conv1d(C->C, k=5, pad=2)] ->
@@ -333,45 +1478,129 @@ private:
 class ConvNet : public NetBase<ConvNet>
 {
 public:
-    explicit ConvNet(Blob blob)
-        : _w(std::move(blob)), _extra_conv(_w.has("conv.0.weight"))
+    static constexpr FeaturePipelineKind PIPELINE = FeaturePipelineKind::CONV;
+
+    explicit ConvNet(const Blob& w)
+        : _extra_conv(w.has("conv.0.weight")),
+          _conv0(_extra_conv ? Conv1d(w, "conv.0", 0) : Conv1d(w, "conv", 0)),
+          _conv_len(_conv0.out_len(BOARD_COLS)),
+          _norm(w, "norm"), _trunk(w)
+    {
+        if(_conv0.in_channels != FEATURE_ROWS)
+            throw std::runtime_error("nardi_infer: first conv does not take the 6 feature rows");
+        _cols = _conv0.cols_size(BOARD_COLS);
+        if(_extra_conv)
+        {
+            _conv2 = Conv1d(w, "conv.2", 2);
+            if(_conv2.in_channels != _conv0.out_channels)
+                throw std::runtime_error("nardi_infer: conv layer channels do not chain");
+            _cols = std::max(_cols, _conv2.cols_size(_conv_len));
+        }
+        _flat = _extra_conv ? _conv2.out_channels * _conv2.out_len(_conv_len)
+                            : _conv0.out_channels * _conv_len;
+        if(_norm.size != _flat || _trunk.in_dim() != _flat + FEATURE_ROWS)
+            throw std::runtime_error("nardi_infer: conv output does not match norm / trunk size");
+        _conv0.bind_columns();
+    }
+
+    // rows x board | rows x first conv (when there are two) | conv scratch |
+    // rows x (flat + scalars) | trunk
+    size_t workspace_size(int rows) const
     {
+        return static_cast<size_t>(rows) * (FEATURE_ROWS * BOARD_COLS + first_conv_size() + _cols + row_size()) +
+               _trunk.workspace_size(rows);
     }
 
-    float forward(const Nardi::Board::Features& f) const
+    void forward(const float* feat, int rows, float* ws, float* out) const
     {
-        float feat[FEAT_ROWS * FEAT_COLS];
-        fill_features(f, feat, ModelKind::CONV);
-        std::vector<float> board;
-        float scalars[FEAT_ROWS];
+        float* boards = ws;
+        float* c0 = boards + static_cast<size_t>(rows) * FEATURE_ROWS * BOARD_COLS;
+        float* cols = c0 + static_cast<size_t>(rows) * first_conv_size();
+        float* xs = cols + static_cast<size_t>(rows) * _cols;
+        float* trunk_ws = xs + static_cast<size_t>(rows) * row_size();
+
+        // scalars land right after each flat block, ready for the trunk
+        for(int r = 0; r < rows; ++r)
+            split_board_scalars(feat + static_cast<size_t>(r) * FEATURE_SIZE,
+                                boards + static_cast<size_t>(r) * FEATURE_ROWS * BOARD_COLS,
+                                xs + static_cast<size_t>(r) * row_size() + _flat);
+        float* first = _extra_conv ? c0 : xs;
+        const size_t first_stride = _extra_conv ? first_conv_size() : row_size();
+        _conv0.forward(boards, rows, BOARD_COLS, FEATURE_ROWS * BOARD_COLS, first, first_stride, cols);
+        finish(first, first_stride, rows, xs, cols);
+        _trunk.value(xs, rows, trunk_ws, out);
+    }
+
+    // first layer: the first conv over the board rows; the scalars skip it
+    size_t accumulator_size() const { return static_cast<size_t>(_conv0.out_channels) * _conv_len; }
+
+    void accumulate(const float* feat, float* acc, float* ws) const
+    {
+        float scalars[FEATURE_ROWS];
+        float* board = ws;
         split_board_scalars(feat, board, scalars);
+        _conv0.forward(board, 1, BOARD_COLS, 0, acc, 0, board + FEATURE_ROWS * BOARD_COLS);
+    }
 
-        std::vector<float> x;
+    void add_input(float* acc, int cell, float x, float x_old) const
+    {
+        const int p = cell % FEATURE_COLS;
+        if(p < BOARD_COLS)
+            _conv0.add_input(acc, BOARD_COLS, cell / FEATURE_COLS, p, x, x_old);
+    }
+
+    void forward_from(const float* feat, float* accs, int rows, float* ws, float* out) const
+    {
+        float* cols = ws;
+        float* xs = cols + static_cast<size_t>(rows) * _cols;
+        float* trunk_ws = xs + static_cast<size_t>(rows) * row_size();
+
+        for(int r = 0; r < rows; ++r)
+            copy_scalars(feat + static_cast<size_t>(r) * FEATURE_SIZE, xs + static_cast<size_t>(r) * row_size() + _flat);
+        finish(accs, accumulator_size(), rows, xs, cols);
+        _trunk.value(xs, rows, trunk_ws, out);
+    }
+
+private:
+    size_t first_conv_size() const
+    {
+        return _extra_conv ? static_cast<size_t>(_conv0.out_channels) * _conv_len : 0;
+    }
+
+    size_t row_size() const { return static_cast<size_t>(_flat) + FEATURE_ROWS; }
+
+    // The block of first-conv outputs `first`, `stride` floats apart, to the
+    // normed flat blocks of xs.
+    void finish(float* first, size_t stride, int rows, float* xs, float* cols) const
+    {
         if(_extra_conv)
         {
-            auto c = conv1d(board.data(), FEAT_ROWS, BOARD_COLS,
-                            _w.at("conv.0.weight"), _w.at("conv.0.bias"), 1, 0);
-            const int channels = _w.at("conv.0.weight").dim(0);
-            const int len = static_cast<int>(c.size()) / channels;
-            relu_inplace(c);
-            x = conv1d(c.data(), channels, len,
-                       _w.at("conv.2.weight"), _w.at("conv.2.bias"), 1, 2);
+            for(int r = 0; r < rows; ++r)
+                relu_inplace(first + r * stride, first_conv_size());
+            _conv2.forward(first, rows, _conv_len, stride, xs, row_size(), cols);
         }
-        else
+        else if(first != xs)
         {
-            x = conv1d(board.data(), FEAT_ROWS, BOARD_COLS,
-                       _w.at("conv.weight"), _w.at("conv.bias"), 1, 0);
+            for(int r = 0; r < rows; ++r)
+                std::copy(first + r * stride, first + r * stride + _flat, xs + r * row_size());
         }
 
-        layer_norm_inplace(x, _w.at("norm.weight"), _w.at("norm.bias"));
-        relu_inplace(x);
-        x.insert(x.end(), scalars, scalars + FEAT_ROWS);
-        return trunk_value(std::move(x), _w);
+        for(int r = 0; r < rows; ++r)
+        {
+            float* x = xs + r * row_size();
+            _norm.forward(x);
+            relu_inplace(x, static_cast<size_t>(_flat));
+        }
     }
 
-private:
-    Blob _w;
     bool _extra_conv;
+    Conv1d _conv0;
+    Conv1d _conv2;
+    int _conv_len;
+    int _flat = 0;
+    size_t _cols = 0;
+    LayerNorm _norm;
+    Trunk _trunk;
 };
 
 // ResNardiNet: residual block (conv1 -> ReLU -> conv2, plus 1x1 proj skip) ->
@@ -379,54 +1608,148 @@ private:
 class ResNet : public NetBase<ResNet>
 {
 public:
-    explicit ResNet(Blob blob) : _w(std::move(blob)) {}
+    static constexpr FeaturePipelineKind PIPELINE = FeaturePipelineKind::CONV;   // res shares the conv layout
 
-    float forward(const Nardi::Board::Features& f) const
+    explicit ResNet(const Blob& w)
+        : _conv1(w, "res_block.conv1", 2), _conv2(w, "res_block.conv2", 2),
+          _proj(w, "res_block.proj", 0), _norm(w, "norm"), _trunk(w)
     {
-        float feat[FEAT_ROWS * FEAT_COLS];
-        fill_features(f, feat, ModelKind::RES);
-        std::vector<float> board;
-        float scalars[FEAT_ROWS];
-        split_board_scalars(feat, board, scalars);
+        const int channels = _conv1.out_channels;
+        if(_conv1.in_channels != FEATURE_ROWS || _proj.in_channels != FEATURE_ROWS
+           || _conv2.in_channels != channels || _conv2.out_channels != channels
+           || _proj.out_channels != channels)
+            throw std::runtime_error("nardi_infer: residual block channels do not chain");
+        if(_conv1.out_len(BOARD_COLS) != BOARD_COLS || _conv2.out_len(BOARD_COLS) != BOARD_COLS
+           || _proj.out_len(BOARD_COLS) != BOARD_COLS)
+            throw std::runtime_error("nardi_infer: residual block must keep the 24 board points");
+
+        _flat = channels * BOARD_COLS;
+        if(_norm.size != _flat || _trunk.in_dim() != _flat + FEATURE_ROWS)
+            throw std::runtime_error("nardi_infer: residual output does not match norm / trunk size");
+        _cols = std::max({_conv1.cols_size(BOARD_COLS), _conv2.cols_size(BOARD_COLS),
+                          _proj.cols_size(BOARD_COLS)});
+        _conv1.bind_columns();
+        _proj.bind_columns();
+    }
+
+    // rows x board | rows x [conv1 | proj] | conv scratch | rows x (conv2 + scalars) | trunk
+    size_t workspace_size(int rows) const
+    {
+        return static_cast<size_t>(rows) * (FEATURE_ROWS * BOARD_COLS + accumulator_size() + _cols + row_size()) +
+               _trunk.workspace_size(rows);
+    }
 
-        auto c1 = conv1d(board.data(), FEAT_ROWS, BOARD_COLS,
-                         _w.at("res_block.conv1.weight"), _w.at("res_block.conv1.bias"), 1, 2);
-        const int conv_out = _w.at("res_block.conv1.weight").dim(0);
-        relu_inplace(c1);
+    void forward(const float* feat, int rows, float* ws, float* out) const
+    {
+        float* boards = ws;
+        float* firsts = boards + static_cast<size_t>(rows) * FEATURE_ROWS * BOARD_COLS;
+        float* cols = firsts + static_cast<size_t>(rows) * accumulator_size();
+        float* xs = cols + static_cast<size_t>(rows) * _cols;
+        float* trunk_ws = xs + static_cast<size_t>(rows) * row_size();
+
+        for(int r = 0; r < rows; ++r)
+            split_board_scalars(feat + static_cast<size_t>(r) * FEATURE_SIZE,
+                                boards + static_cast<size_t>(r) * FEATURE_ROWS * BOARD_COLS,
+                                xs + static_cast<size_t>(r) * row_size() + _flat);
+        first_layer(boards, rows, firsts, cols);
+        finish(firsts, rows, xs, cols);
+        _trunk.value(xs, rows, trunk_ws, out);
+    }
 
-        auto c2 = conv1d(c1.data(), conv_out, BOARD_COLS,
-                         _w.at("res_block.conv2.weight"), _w.at("res_block.conv2.bias"), 1, 2);
+    // first layer: conv1 and the proj skip, both over the board rows, as [conv1 | proj]
+    size_t accumulator_size() const { return static_cast<size_t>(_flat) * 2; }
 
-        auto proj = conv1d(board.data(), FEAT_ROWS, BOARD_COLS,
-                           _w.at("res_block.proj.weight"), _w.at("res_block.proj.bias"), 1, 0);
+    void accumulate(const float* feat, float* acc, float* ws) const
+    {
+        float scalars[FEATURE_ROWS];
+        float* board = ws;
+        split_board_scalars(feat, board, scalars);
+        first_layer(board, 1, acc, board + FEATURE_ROWS * BOARD_COLS);
+    }
 
-        for(size_t i = 0; i < c2.size(); ++i)
-            c2[i] += proj[i];
-        relu_inplace(c2); // flattened [conv_out * 24], channel-major == torch flatten(1)
+    void add_input(float* acc, int cell, float x, float x_old) const
+    {
+        const int p = cell % FEATURE_COLS;
+        if(p == BOARD_COLS)
+            return;
+        _conv1.add_input(acc, BOARD_COLS, cell / FEATURE_COLS, p, x, x_old);
+        _proj.add_input(acc + _flat, BOARD_COLS, cell / FEATURE_COLS, p, x, x_old);
+    }
 
-        layer_norm_inplace(c2, _w.at("norm.weight"), _w.at("norm.bias"));
-        relu_inplace(c2);
-        c2.insert(c2.end(), scalars, scalars + FEAT_ROWS);
-        return trunk_value(std::move(c2), _w);
+    void forward_from(const float* feat, float* accs, int rows, float* ws, float* out) const
+    {
+        float* cols = ws;
+        float* xs = cols + static_cast<size_t>(rows) * _cols;
+        float* trunk_ws = xs + static_cast<size_t>(rows) * row_size();
+
+        for(int r = 0; r < rows; ++r)
+            copy_scalars(feat + static_cast<size_t>(r) * FEATURE_SIZE, xs + static_cast<size_t>(r) * row_size() + _flat);
+        finish(accs, rows, xs, cols);
+        _trunk.value(xs, rows, trunk_ws, out);
     }
 
 private:
-    Blob _w;
+    size_t row_size() const { return static_cast<size_t>(_flat) + FEATURE_ROWS; }
+
+    // conv1 and proj over `rows` boards into accumulator_size() blocks
+    void first_layer(const float* boards, int rows, float* firsts, float* cols) const
+    {
+        _conv1.forward(boards, rows, BOARD_COLS, FEATURE_ROWS * BOARD_COLS, firsts, accumulator_size(), cols);
+        _proj.forward(boards, rows, BOARD_COLS, FEATURE_ROWS * BOARD_COLS, firsts + _flat, accumulator_size(), cols);
+    }
+
+    // The block of [conv1 | proj] outputs to the normed flat blocks of xs.
+    void finish(float* firsts, int rows, float* xs, float* cols) const
+    {
+        for(int r = 0; r < rows; ++r)
+            relu_inplace(firsts + r * accumulator_size(), static_cast<size_t>(_flat));
+        _conv2.forward(firsts, rows, BOARD_COLS, accumulator_size(), xs, row_size(), cols);
+
+        for(int r = 0; r < rows; ++r)
+        {
+            float* c2 = xs + r * row_size();
+            const float* proj = firsts + r * accumulator_size() + _flat;
+            for(int i = 0; i < _flat; ++i)
+                c2[i] += proj[i];
+            relu_inplace(c2, static_cast<size_t>(_flat)); // flattened [channels * 24], channel-major == torch flatten(1)
+
+            _norm.forward(c2);
+            relu_inplace(c2, static_cast<size_t>(_flat));
+        }
+    }
+
+    Conv1d _conv1;
+    Conv1d _conv2;
+    Conv1d _proj;
+    LayerNorm _norm;
+    Trunk _trunk;
+    int _flat = 0;
+    size_t _cols = 0;
 };
 
 } // namespace
 
+void set_infer_kernels(InferKernels kernels)
+{
+    use_reference_kernels.store(kernels == InferKernels::REFERENCE, std::memory_order_relaxed);
+}
+
+const char* infer_kernel_name()
+{
+    return active_kernels().name;
+}
+
 std::unique_ptr<InferenceNet> load_inference_net(const std::string& path)
 {
     Blob blob = read_blob(path);
     switch(blob.kind)
     {
     case ModelKind::LEGACY:
-        return std::make_unique<MlpNet>(std::move(blob));
+        return std::make_unique<MlpNet>(blob);
     case ModelKind::CONV:
-        return std::make_unique<ConvNet>(std::move(blob));
+        return std::make_unique<ConvNet>(blob);
     case ModelKind::RES:
-        return std::make_unique<ResNet>(std::move(blob));
+        return std::make_unique<ResNet>(blob);
     default:
         throw std::runtime_error("nardi_infer: unknown model kind in weight blob");
     }
@@ -4,7 +4,7 @@
 #include <string>
 #include <vector>
 
-#include "../CoreEngine/Board.h"
+#include "nardi_core.h"
 
 namespace nardi_py
 {
@@ -20,6 +20,12 @@ namespace nardi_py
 // evaluate() / evaluate_batch() return the side-to-move value, identical to
 // calling model(features) in Python (i.e. model.value_from_tensor of the conv
 // or legacy feature tensor).
+//
+// A blob exported with export_weights(..., quantize=True) stores the conv layers
+// and hidden trunk layers as int8 weights with per-output-channel scales; those
+// layers then run in integer arithmetic on activations quantized with the
+// calibrated input scale, while LayerNorm and the value head stay float. Values
+// track the float net closely but not exactly.
 class InferenceNet
 {
 public:
@@ -28,11 +34,44 @@ public:
     // Side-to-move value for one position.
     virtual float evaluate(const Nardi::Board::Features& f) const = 0;
 
+    // Side-to-move value of `board` with `side` to move, featured in place.
+    virtual float evaluate(const Nardi::Board& board, bool side) const = 0;
+
     // Batched evaluation (the workhorse for MCTS rollouts / prior expansion).
     virtual std::vector<float> evaluate_batch(
         const std::vector<Nardi::Board::Features>& features) const = 0;
+    virtual std::vector<float> evaluate_batch(const std::vector<EvalPosition>& positions) const = 0;
+
+    // evaluate_batch for positions a few checker moves from `parent`, featured
+    // for the same side (one roll's afterstates, a lookahead's leaves). The
+    // first layer -- trunk.0 of the MLP, the conv(s) reading the board rows of
+    // the conv nets -- is linear in the features, so it runs once on `parent`
+    // and each position's output is the parent's plus the weight columns of the
+    // cells that differ: O(changed cells * width) per position rather than
+    // O(150 * width). Values match evaluate_batch up to float rounding, which
+    // an int8 net's next layer can round up to one input step. Any positions
+    // are valid; the saving just shrinks as more cells differ.
+    virtual std::vector<float> evaluate_siblings(
+        const Nardi::Board::Features& parent,
+        const std::vector<Nardi::Board::Features>& features) const = 0;
+    virtual std::vector<float> evaluate_siblings(const EvalPosition& parent,
+                                                 const std::vector<EvalPosition>& positions) const = 0;
 };
 
+// Layer kernels for networks loaded after the call. AUTO (the default) takes
+// the widest SIMD set the CPU reports at runtime: AVX-512 or AVX2+FMA on x86,
+// NEON on ARM64. REFERENCE forces the portable scalar kernels, the parity
+// reference; SIMD values differ from it only by fused multiply-add rounding.
+enum class InferKernels
+{
+    AUTO,
+    REFERENCE
+};
+void set_infer_kernels(InferKernels kernels);
+
+// Kernel set the next load will use: "avx512", "avx2", "neon" or "reference".
+const char* infer_kernel_name();
+
 // Load a weight blob and construct the matching network. Throws std::runtime_error
 // on a malformed file or unsupported architecture tag.
 std::unique_ptr<InferenceNet> load_inference_net(const std::string& path);
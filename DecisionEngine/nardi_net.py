@@ -205,8 +205,15 @@ import struct
 #   then per tensor: name_len u32 | name bytes | ndim u32 | dims u32... | float32 data
 # `kind` selects the C++ architecture: 0 = NardiNet (MLP), 1 = ConvNardiNet,
 # 2 = ResNardiNet.
+#
+# Version 2 (quantized export) adds a dtype u32 after the name (0 = float32,
+# 1 = int8). A quantized layer stores <prefix>.weight as int8 plus float32
+# <prefix>.weight_scale [out] and <prefix>.input_range [1]; see export_weights.
 _WEIGHT_MAGIC = b"NRDW"
 _WEIGHT_VERSION = 1
+_WEIGHT_VERSION_TYPED = 2
+_DTYPE_FLOAT32 = 0
+_DTYPE_INT8 = 1
 
 
 def _model_kind(model):
@@ -220,29 +227,126 @@ def _model_kind(model):
     raise TypeError(f"export_weights: unsupported model type {type(model).__name__}")
 
 
-def export_weights(model, path):
+def sample_positions(n_positions=2048):
+    """Features for a spread of positions: random self-play with a jump to a
+    random endgame every 25 turns, each turn's position plus its afterstates.
+    Used to calibrate quantized exports. Positions come from the engine's own
+    RNG, so the caller's Python and numpy RNG state is left untouched."""
+    eng = nardi.Engine()
+    eng.reset()
+    features = []
+    steps = 0
+    while len(features) < n_positions:
+        if steps % 25 == 0:
+            eng.config().withRandomEndgame(bool(steps % 2))
+        elif not eng.should_continue_game():
+            eng.reset()
+
+        options = eng.roll_and_enumerate()
+        features.append(eng.board_features())
+        features.extend(options)
+        if options:
+            eng.apply_random_board()
+        else:
+            eng.confirm_turn()
+        steps += 1
+    return features[:n_positions]
+
+
+def _quantized_layers(model):
+    """Module names export_weights(quantize=True) stores in int8: every conv and
+    every trunk Linear except the value head, which stays float like LayerNorm."""
+    linears = [name for name, m in model.named_modules()
+               if isinstance(m, nn.Linear) and name.startswith("trunk.")]
+    convs = [name for name, m in model.named_modules() if isinstance(m, nn.Conv1d)]
+    return convs + linears[:-1]
+
+
+def _calibrate_input_ranges(model, names, calibration, batch_size=512):
+    """Largest |input| each named module sees over the calibration positions."""
+    modules = dict(model.named_modules())
+    ranges = {name: 0.0 for name in names}
+
+    def hook(name):
+        def record(_module, inputs):
+            ranges[name] = max(ranges[name], float(inputs[0].detach().abs().max()))
+        return record
+
+    handles = [modules[name].register_forward_pre_hook(hook(name)) for name in names]
+    try:
+        with torch.inference_mode():
+            for i in range(0, len(calibration), batch_size):
+                model(calibration[i:i + batch_size])
+    finally:
+        for h in handles:
+            h.remove()
+    return ranges
+
+
+def _quantize_weight(weight):
+    """Symmetric int8 per output channel: (int8 weight, float32 scale [out])."""
+    w = weight.detach().to("cpu").float().reshape(weight.shape[0], -1)
+    scale = w.abs().amax(dim=1) / 127.0
+    scale = torch.where(scale > 0, scale, torch.ones_like(scale))
+    q = torch.round(w / scale[:, None]).clamp(-127, 127).to(torch.int8)
+    return q.reshape(weight.shape).numpy(), scale.numpy()
+
+
+def export_weights(model, path, quantize=False, calibration=None):
     """Serialize a model's parameters + buffers to a flat .nardiw blob for the
     hand-rolled, torch-free C++ inference net (iOS / parity test). State-dict keys
     (e.g. trunk.0.weight, res_block.conv1.weight, scores) are written verbatim so
     the C++ side can look them up by name. Returns `path`. NOTE: the TorchScript
     export_target_network above remains the path for the LibTorch C++ target
-    network used in training; this is the separate torch-free blob for iOS."""
+    network used in training; this is the separate torch-free blob for iOS.
+
+    quantize=True writes the conv and hidden trunk weights as int8 with a scale
+    per output channel, plus each layer's input range measured over `calibration`
+    (Features or a pipeline tensor; default sample_positions()). The C++ net runs
+    those layers in integer arithmetic; LayerNorm and the value head stay float."""
     was_training = model.training
     model.eval()
     kind = _model_kind(model)
     state = model.state_dict()
+
+    quantized = {}
+    if quantize:
+        names = _quantized_layers(model)
+        ranges = _calibrate_input_ranges(
+            model, names, calibration if calibration is not None else sample_positions())
+        for name in names:
+            q, scale = _quantize_weight(state[name + ".weight"])
+            quantized[name + ".weight"] = (q, scale, ranges[name] or 1.0)
+
+    tensors = []
+    for name, tensor in state.items():
+        if name in quantized:
+            q, scale, input_range = quantized[name]
+            prefix = name[:-len(".weight")]
+            tensors.append((name, _DTYPE_INT8, q.astype("i1", copy=False)))
+            tensors.append((prefix + ".weight_scale", _DTYPE_FLOAT32, scale))
+            tensors.append((prefix + ".input_range", _DTYPE_FLOAT32,
+                            np.array([input_range], dtype=np.float32)))
+        else:
+            tensors.append((name, _DTYPE_FLOAT32, tensor.detach().to("cpu").contiguous().float().numpy()))
+
+    version = _WEIGHT_VERSION_TYPED if quantize else _WEIGHT_VERSION
     with open(path, "wb") as fh:
         fh.write(_WEIGHT_MAGIC)
-        fh.write(struct.pack("<III", _WEIGHT_VERSION, kind, len(state)))
-        for name, tensor in state.items():
-            arr = tensor.detach().to("cpu").contiguous().float().numpy()
+        fh.write(struct.pack("<III", version, kind, len(tensors)))
+        for name, dtype, arr in tensors:
             name_b = name.encode("utf-8")
             fh.write(struct.pack("<I", len(name_b)))
             fh.write(name_b)
+            if version == _WEIGHT_VERSION_TYPED:
+                fh.write(struct.pack("<I", dtype))
             fh.write(struct.pack("<I", arr.ndim))
             for dim in arr.shape:
                 fh.write(struct.pack("<I", int(dim)))
-            fh.write(arr.astype("<f4", copy=False).tobytes())
+            if dtype == _DTYPE_INT8:
+                fh.write(arr.tobytes())
+            else:
+                fh.write(arr.astype("<f4", copy=False).tobytes())
     if was_training:
         model.train()
     return path
@@ -0,0 +1,160 @@
+"""Int8 vs float benchmark for the hand-rolled C++ value net (nardi.InferenceNet).
+
+Exports one model twice with nardi_net.export_weights -- as float, and quantized
+(int8 conv / trunk weights, input ranges calibrated on sampled positions) -- and
+reports:
+
+  * parity: |int8 - float| value error over held-out positions, and how often
+    both nets pick the same greedy move among a rolled position's afterstates;
+  * speed: evaluate_batch throughput of each net and the blob sizes;
+  * strength: greedy head-to-head games, int8 net vs float net, alternating colors.
+
+Example:
+    venv/bin/python quant_benchmark.py --weights weights/res2.pt --arch ResNet \
+        --positions 4000 --games 400
+"""
+
+import argparse
+import os
+import tempfile
+import time
+
+import numpy as np
+import torch
+
+import nardi
+from mcts_benchmark import build_model
+from nardi_net import export_weights, sample_positions
+
+
+class _NetModel:
+    """Greedy-strategy adapter: model(options) -> tensor of side-to-move values."""
+
+    def __init__(self, net):
+        self.net = net
+
+    def __call__(self, features):
+        return torch.from_numpy(np.asarray(self.net.evaluate_batch(list(features)), dtype=np.float32))
+
+
+def value_parity(float_net, quant_net, features):
+    ref = np.asarray(float_net.evaluate_batch(features), dtype=np.float64)
+    got = np.asarray(quant_net.evaluate_batch(features), dtype=np.float64)
+    diff = np.abs(got - ref)
+    return {"max": float(diff.max()), "mean": float(diff.mean()), "p99": float(np.quantile(diff, 0.99))}
+
+
+def move_agreement(float_net, quant_net, n_turns, seed):
+    """Fraction of rolled positions (with a choice of move) where both nets'
+    greedy move is the same afterstate."""
+    np.random.seed(seed)
+    eng = nardi.Engine()
+    eng.reset()
+    same = total = 0
+    while total < n_turns:
+        if not eng.should_continue_game():
+            eng.reset()
+        options = eng.roll_and_enumerate()
+        if len(options) > 1:
+            a = np.argmax(float_net.evaluate_batch(options))
+            b = np.argmax(quant_net.evaluate_batch(options))
+            same += int(a == b)
+            total += 1
+        if options:
+            eng.apply_random_board()
+        else:
+            eng.confirm_turn()
+    return same / total
+
+
+def throughput(net, features, reps):
+    net.evaluate_batch(features)   # warm the workspace
+    t0 = time.perf_counter()
+    for _ in range(reps):
+        net.evaluate_batch(features)
+    return reps * len(features) / (time.perf_counter() - t0)
+
+
+def head_to_head(float_net, quant_net, n_games):
+    """Greedy int8 vs greedy float; returns (int8 points, float points)."""
+    from sim_play import Simulator
+
+    sim = Simulator()
+    move_quant = sim.strat_to_func(_NetModel(quant_net), "greedy")
+    move_float = sim.strat_to_func(_NetModel(float_net), "greedy")
+    score_quant = score_float = 0
+    for g in range(n_games):
+        r = sim.simulate_game(move_quant, move_float, swap_order=bool(g % 2))
+        score_quant += r[0]
+        score_float += r[1]
+    return score_quant, score_float
+
+
+def benchmark(weights, architecture="ResNet", n_calibration=2048, n_positions=4000,
+              n_turns=1000, n_games=200, reps=20, seed=0):
+    model = build_model(architecture)
+    if weights:
+        model.load_state_dict(torch.load(weights, map_location="cpu", weights_only=True))
+    model.eval()
+
+    tmp = tempfile.gettempdir()
+    float_path = os.path.join(tmp, f"quant_bench_float_{os.getpid()}.nardiw")
+    quant_path = os.path.join(tmp, f"quant_bench_int8_{os.getpid()}.nardiw")
+    try:
+        export_weights(model, float_path)
+        export_weights(model, quant_path, quantize=True,
+                       calibration=sample_positions(n_calibration))
+        float_net = nardi.InferenceNet(float_path)
+        quant_net = nardi.InferenceNet(quant_path)
+        float_size = os.path.getsize(float_path)
+        quant_size = os.path.getsize(quant_path)
+    finally:
+        for path in (float_path, quant_path):
+            if os.path.exists(path):
+                os.remove(path)
+
+    held_out = sample_positions(n_positions)
+    parity = value_parity(float_net, quant_net, held_out)
+    agreement = move_agreement(float_net, quant_net, n_turns, seed + 2)
+    float_rate = throughput(float_net, held_out, reps)
+    quant_rate = throughput(quant_net, held_out, reps)
+
+    print(f"\nint8 vs float  ({architecture} model: {weights}, kernels: {nardi.infer_kernels()})")
+    print(f"  calibration positions={n_calibration}, held-out positions={len(held_out)}")
+    print(f"  value |diff|: max {parity['max']:.4f}  p99 {parity['p99']:.4f}  mean {parity['mean']:.5f}")
+    print(f"  greedy move agreement: {agreement * 100:.2f}% over {n_turns} rolled positions")
+    print(f"  throughput: float {float_rate:,.0f} pos/s  int8 {quant_rate:,.0f} pos/s "
+          f"({quant_rate / float_rate:.2f}x)")
+    print(f"  blob size: float {float_size:,} B  int8 {quant_size:,} B")
+
+    result = {"parity": parity, "agreement": agreement,
+              "float_rate": float_rate, "quant_rate": quant_rate}
+    if n_games > 0:
+        score_quant, score_float = head_to_head(float_net, quant_net, n_games)
+        total = score_quant + score_float
+        wr = score_quant / total if total else float("nan")
+        print(f"  greedy games={n_games}: int8={score_quant}  float={score_float} points "
+              f"(int8 win rate by points {wr * 100:.2f}%)")
+        result.update(score_quant=score_quant, score_float=score_float)
+    return result
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Int8 vs float C++ value net: parity, speed, strength.")
+    ap.add_argument("--weights", default="weights/res2.pt")
+    ap.add_argument("--architecture", "--arch", default="ResNet",
+                    choices=["Conv", "DeepConv", "ResNet", "MLP"])
+    ap.add_argument("--calibration", type=int, default=2048, help="positions used to calibrate input ranges.")
+    ap.add_argument("--positions", type=int, default=4000, help="held-out positions for value parity / speed.")
+    ap.add_argument("--turns", type=int, default=1000, help="rolled positions for greedy move agreement.")
+    ap.add_argument("--games", type=int, default=200, help="greedy int8 vs float games (0 to skip).")
+    ap.add_argument("--reps", type=int, default=20, help="evaluate_batch repetitions for throughput.")
+    ap.add_argument("--seed", type=int, default=0)
+    args = ap.parse_args()
+
+    benchmark(args.weights, args.architecture, args.calibration, args.positions,
+              args.turns, args.games, args.reps, args.seed)
+
+
+if __name__ == "__main__":
+    main()
@@ -33,6 +33,8 @@ class Simulator:
         self.mcts_rollouts_per_leaf = 0   # 0 => value-net leaf (recommended); >0 => avg rollouts
         self._mcts_target_path = None
 
+        self._feature_buf = None      # reused lookahead model input, see lookahead_input
+
     @property
     def sign(self):
         return self.eng.sign()
@@ -80,6 +82,22 @@ class Simulator:
                 )
         return
 
+    def lookahead_input(self, batch, kind, flatten):
+        """Fill a reused host buffer with the batch's model input and return it on
+        self.device. The buffer only grows (pinned when copying to CUDA), so a
+        move no longer allocates and faults in a fresh feature array."""
+        n = batch.num_eval_features
+        shape = (150,) if flatten else (6, 25)
+        buf = self._feature_buf
+        if buf is None or buf.shape[1:] != shape or buf.shape[0] < n:
+            rows = max(n, 2 * buf.shape[0] if buf is not None else 0)
+            buf = torch.empty((rows,) + shape, dtype=torch.float32)
+            if self.device.type == "cuda":
+                buf = buf.pin_memory()
+            self._feature_buf = buf
+        batch.tensor_out(buf.numpy(), kind)
+        return buf[:n].to(self.device, non_blocking=True)
+
     def evaluate_lookahead_batch(self, batch, model):
         """
         Args:
@@ -99,7 +117,7 @@ class Simulator:
         self.ensure_model_on_device(model)
         # C++ owns the search tree and feature layout; Python only runs the model
         # over the flat feature batch and returns values to C++ for aggregation.
-        x = torch.from_numpy(batch.tensor(kind, flatten)).to(self.device)
+        x = self.lookahead_input(batch, kind, flatten)
         with torch.inference_mode():
             values = model(x)
         return values.detach().cpu().numpy().astype(np.float32, copy=False)
@@ -1,5 +1,6 @@
 #include "target_model.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 // Two interchangeable inference backends behind the same TargetModel interface,
@@ -14,7 +15,7 @@
 #include <ATen/Parallel.h>
 #include <torch/script.h>
 
-#include "../CoreEngine/Auxilaries.h"
+#include "nardi_core.h"
 
 namespace nardi_py
 {
@@ -22,36 +23,12 @@ namespace nardi_py
 namespace
 {
 
-constexpr int FEAT_ROWS = 6;
-constexpr int FEAT_COLS = Nardi::ROWS * Nardi::COLS + 1; // 25
-constexpr float FEAT_SCALE = 15.0f;
-
-// Fill a [6, 25] row-major block for one Features object, matching the conv
-// pipeline layout produced by binding_utils::feature_batch_to_tensor (kind=conv):
-//   rows 0-2 : player occupancy planes
-//   rows 3-5 : opponent occupancy planes
-//   last col : per-row scalars (pieces_off, pip_count, pieces_not_reached)
-// Everything divided by 15.
-void fill_features(const Nardi::Board::Features& f, float* out)
-{
-    for(int row = 0; row < 3; ++row)
-        for(int col = 0; col < Nardi::ROWS * Nardi::COLS; ++col)
-            out[row * FEAT_COLS + col] = static_cast<float>(f.player.occ[row][col]) / FEAT_SCALE;
-
-    for(int row = 0; row < 3; ++row)
-        for(int col = 0; col < Nardi::ROWS * Nardi::COLS; ++col)
-            out[(row + 3) * FEAT_COLS + col] = static_cast<float>(f.opp.occ[row][col]) / FEAT_SCALE;
-
-    const float scalars[FEAT_ROWS] = {
-        static_cast<float>(f.player.pieces_off),
-        static_cast<float>(f.opp.pieces_off),
-        static_cast<float>(f.player.pip_count),
-        static_cast<float>(f.opp.pip_count),
-        static_cast<float>(f.player.pieces_not_reached),
-        static_cast<float>(f.opp.pieces_not_reached)
-    };
-    for(int row = 0; row < FEAT_ROWS; ++row)
-        out[row * FEAT_COLS + (FEAT_COLS - 1)] = scalars[row] / FEAT_SCALE;
+// Run a filled [n, 6, 25] input through the module; one value per row.
+std::vector<float> forward_values(torch::jit::script::Module& module, const torch::Tensor& input, int n)
+{
+    auto output = module.forward({input}).toTensor().contiguous().to(torch::kFloat32);
+    const float* acc = output.data_ptr<float>();
+    return std::vector<float>(acc, acc + n);
 }
 
 } // namespace
@@ -79,7 +56,7 @@ bool TargetModel::is_loaded() const { return _impl->loaded; }
 
 float TargetModel::evaluate(const Nardi::Board::Features& f) const
 {
-    return evaluate_batch({f}).front();
+    return evaluate_batch(std::vector<Nardi::Board::Features>{f}).front();
 }
 
 std::vector<float> TargetModel::evaluate_batch(const std::vector<Nardi::Board::Features>& features) const
@@ -88,25 +65,69 @@ std::vector<float> TargetModel::evaluate_batch(const std::vector<Nardi::Board::F
         throw std::runtime_error("TargetModel: no network loaded (call load() first).");
 
     const int n = static_cast<int>(features.size());
-    std::vector<float> result(static_cast<size_t>(n));
     if(n == 0)
-        return result;
+        return {};
 
     torch::InferenceMode guard;
 
-    auto input = torch::empty({n, FEAT_ROWS, FEAT_COLS}, torch::kFloat32);
+    auto input = torch::empty({n, FEATURE_ROWS, FEATURE_COLS}, torch::kFloat32);
     float* data = input.data_ptr<float>();
     for(int i = 0; i < n; ++i)
-        fill_features(features[static_cast<size_t>(i)], data + i * FEAT_ROWS * FEAT_COLS);
+        write_features(features[static_cast<size_t>(i)], FeaturePipelineKind::CONV, data + i * FEATURE_SIZE);
 
-    auto output = _impl->module.forward({input}).toTensor().contiguous().to(torch::kFloat32);
-    const float* acc = output.data_ptr<float>();
-    for(int i = 0; i < n; ++i)
-        result[static_cast<size_t>(i)] = acc[i];
+    return forward_values(_impl->module, input, n);
+}
+
+std::vector<float> TargetModel::evaluate_batch(const std::vector<EvalPosition>& positions) const
+{
+    if(!_impl->loaded)
+        throw std::runtime_error("TargetModel: no network loaded (call load() first).");
 
+    // Featured a chunk at a time, so a large frontier never needs its whole
+    // float tensor at once.
+    constexpr int CHUNK = 4096;
+    torch::InferenceMode guard;
+
+    std::vector<float> result;
+    result.reserve(positions.size());
+    for(size_t begin = 0; begin < positions.size(); begin += CHUNK)
+    {
+        const int n = static_cast<int>(std::min<size_t>(CHUNK, positions.size() - begin));
+        auto input = torch::empty({n, FEATURE_ROWS, FEATURE_COLS}, torch::kFloat32);
+        float* data = input.data_ptr<float>();
+        for(int i = 0; i < n; ++i)
+            write_features(positions[begin + static_cast<size_t>(i)], FeaturePipelineKind::CONV, data + i * FEATURE_SIZE);
+
+        const auto values = forward_values(_impl->module, input, n);
+        result.insert(result.end(), values.begin(), values.end());
+    }
     return result;
 }
 
+std::vector<float> TargetModel::evaluate_siblings(const Nardi::Board::Features& /*parent*/,
+                                                  const std::vector<Nardi::Board::Features>& features) const
+{
+    return evaluate_batch(features);
+}
+
+std::vector<float> TargetModel::evaluate_siblings(const EvalPosition& /*parent*/,
+                                                  const std::vector<EvalPosition>& positions) const
+{
+    return evaluate_batch(positions);
+}
+
+float TargetModel::evaluate(const Nardi::Board& board, bool side) const
+{
+    if(!_impl->loaded)
+        throw std::runtime_error("TargetModel: no network loaded (call load() first).");
+
+    torch::InferenceMode guard;
+
+    auto input = torch::empty({1, FEATURE_ROWS, FEATURE_COLS}, torch::kFloat32);
+    write_features(board, side, FeaturePipelineKind::CONV, input.data_ptr<float>());
+    return forward_values(_impl->module, input, 1).front();
+}
+
 } // namespace nardi_py
 
 #else // !NARDI_ENABLE_TORCH  -- hand-rolled, dependency-free backend (iOS)
@@ -147,6 +168,36 @@ std::vector<float> TargetModel::evaluate_batch(const std::vector<Nardi::Board::F
     return _impl->net->evaluate_batch(features);
 }
 
+std::vector<float> TargetModel::evaluate_batch(const std::vector<EvalPosition>& positions) const
+{
+    if(!_impl->net)
+        throw std::runtime_error("TargetModel: no network loaded (call load() first).");
+    return _impl->net->evaluate_batch(positions);
+}
+
+std::vector<float> TargetModel::evaluate_siblings(const Nardi::Board::Features& parent,
+                                                  const std::vector<Nardi::Board::Features>& features) const
+{
+    if(!_impl->net)
+        throw std::runtime_error("TargetModel: no network loaded (call load() first).");
+    return _impl->net->evaluate_siblings(parent, features);
+}
+
+std::vector<float> TargetModel::evaluate_siblings(const EvalPosition& parent,
+                                                  const std::vector<EvalPosition>& positions) const
+{
+    if(!_impl->net)
+        throw std::runtime_error("TargetModel: no network loaded (call load() first).");
+    return _impl->net->evaluate_siblings(parent, positions);
+}
+
+float TargetModel::evaluate(const Nardi::Board& board, bool side) const
+{
+    if(!_impl->net)
+        throw std::runtime_error("TargetModel: no network loaded (call load() first).");
+    return _impl->net->evaluate(board, side);
+}
+
 } // namespace nardi_py
 
 #endif // NARDI_ENABLE_TORCH
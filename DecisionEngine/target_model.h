@@ -4,7 +4,7 @@
 #include <string>
 #include <vector>
 
-#include "../CoreEngine/Board.h"
+#include "nardi_core.h"
 
 namespace nardi_py
 {
@@ -33,9 +33,24 @@ public:
     // Evaluate one position's features -> side-to-move value.
     float evaluate(const Nardi::Board::Features& f) const;
 
+    // The same for `board` with `side` to move, written straight to model input.
+    float evaluate(const Nardi::Board& board, bool side) const;
+
     // Batched evaluation; the workhorse for rollouts and node-prior expansion.
     std::vector<float> evaluate_batch(const std::vector<Nardi::Board::Features>& features) const;
 
+    // The same over compactly stored positions, featured as they are consumed.
+    std::vector<float> evaluate_batch(const std::vector<EvalPosition>& positions) const;
+
+    // evaluate_batch for positions a few checker moves from `parent`, featured
+    // for the same side: the first layer runs once on the parent and is updated
+    // per position from the cells that differ (InferenceNet::evaluate_siblings).
+    // The TorchScript backend has no such hook and evaluates them in full.
+    std::vector<float> evaluate_siblings(const Nardi::Board::Features& parent,
+                                         const std::vector<Nardi::Board::Features>& features) const;
+    std::vector<float> evaluate_siblings(const EvalPosition& parent,
+                                         const std::vector<EvalPosition>& positions) const;
+
 private:
     struct Impl;
     std::unique_ptr<Impl> _impl;
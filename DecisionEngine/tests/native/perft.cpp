@@ -0,0 +1,169 @@
+// Move-generation perft and throughput benchmark. Expands every one of the 21
+// distinct rolls at each chance layer and counts the afterstates (leaf turns)
+// to a given depth, from a fixed corpus of positions. Uses the same search path
+// as the engine (Game::GenerateAfterstates + trusted make/unmake), so the counts
+// are a correctness oracle for movegen changes and the timings track its speed.
+//
+// Counts are per roll, not probability weighted: a doubles roll and a mixed
+// roll each contribute their own afterstates once. A roll with no legal move
+// counts as one node (the pass); a turn that bears off the last checker is a
+// leaf. Built without Python or SFML (see perft.sh).
+//
+// Usage: perft [max_depth=2] [position_name]
+// Exit status is 1 if any count up to depth 2 differs from the known-good table.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "../../../CoreEngine/ScenarioBuilder.h"
+
+namespace
+{
+
+using Nardi::BoardConfig;
+
+struct PerftPosition
+{
+    const char* name;
+    BoardConfig board;
+    bool player;
+    int white_turns;
+    int black_turns;
+    uint64_t expected[2];   // depth 1, depth 2
+};
+
+const PerftPosition CORPUS[] = {
+    // white's first turn: 4-4 and 6-6 take the first-move head exception
+    { "opening", TestGlobals::start_brd, Nardi::white, 0, 0, {21, 441} },
+
+    // black's first turn after white's 4-4 (two checkers to 8) and 6-6 (two to 6)
+    { "reply-4-4", {{ { 13, 0, 0, 0, 0, 0, 0, 0, 2, 0, 0, 0},
+                      {-15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0} }}, Nardi::black, 1, 0, {21, 1908} },
+    { "reply-6-6", {{ { 13, 0, 0, 0, 0, 0, 2, 0, 0, 0, 0, 0},
+                      {-15, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0} }}, Nardi::black, 1, 0, {21, 1809} },
+
+    // mid-game blocks: a six-point prime, a prime wrapping past the row end,
+    // doubles against a long block, and a position heavy with preventions
+    { "block-prime",   TestGlobals::block_check1, Nardi::black, 5, 5, {1222, 39239} },
+    { "block-wrap",    TestGlobals::block_wrap1,  Nardi::white, 5, 5, {270, 22581} },
+    { "block-doubles", TestGlobals::block_doub1,  Nardi::white, 5, 5, {313, 383599} },
+    { "preventions",   TestGlobals::preventions3, Nardi::white, 5, 5, {314, 20802} },
+
+    // both sides home: bear-off from either side's move
+    { "bearoff-white", {{ { 0, 0, 0, 0, 0, 0,-2,-2,-3,-3,-3,-2},
+                          { 0, 0, 0, 0, 0, 0, 3, 3, 3, 2, 2, 2} }}, Nardi::white, 20, 20, {374, 135014} },
+    { "bearoff-black", {{ { 0, 0, 0, 0, 0, 0,-2,-2,-3,-3,-3,-2},
+                          { 0, 0, 0, 0, 0, 0, 3, 3, 3, 2, 2, 2} }}, Nardi::black, 20, 20, {361, 135014} },
+};
+
+class Perft
+{
+    public:
+        Perft(Nardi::ScenarioBuilder& b, int max_depth) : _b(b), _bufs(max_depth + 1) {}
+
+        // Leaf count at `depth` below the current pre-roll position.
+        uint64_t Run(int depth)
+        {
+            if(depth == 0)
+                return 1;
+
+            Nardi::Game& g = _b.GetGame();
+            Nardi::AfterstateBuffer& turns = _bufs[depth];   // this layer's own, kept across rolls
+            uint64_t nodes = 0;
+            ++positions;
+
+            for(const Nardi::DieType& roll : Nardi::RollAfterstates::ROLLS)
+            {
+                g.GenerateAfterstates(roll, turns);
+                generated += turns.size();
+
+                if(turns.empty())
+                {
+                    auto undo = _b.ApplyTrusted(Nardi::PackedSeq{});   // pass
+                    nodes += Run(depth - 1);
+                    _b.UndoTrusted(undo);
+                    continue;
+                }
+                for(const Nardi::Afterstate& turn : turns)
+                {
+                    auto undo = _b.ApplyTrusted(turn.seq);
+                    const auto& left = g.GetBoardRef().PiecesLeft();
+                    nodes += (left[0] == 0 || left[1] == 0) ? 1 : Run(depth - 1);
+                    _b.UndoTrusted(undo);
+                }
+            }
+            return nodes;
+        }
+
+        uint64_t positions = 0;     // pre-roll positions expanded (21 rolls each)
+        uint64_t generated = 0;     // afterstates emitted by movegen
+
+    private:
+        Nardi::ScenarioBuilder& _b;
+        std::vector<Nardi::AfterstateBuffer> _bufs;
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int max_depth = argc > 1 ? std::atoi(argv[1]) : 2;
+    const char* only = argc > 2 ? argv[2] : nullptr;
+    if(max_depth < 1)
+    {
+        std::fprintf(stderr, "usage: %s [max_depth>=1] [position_name]\n", argv[0]);
+        return 2;
+    }
+
+    Nardi::ScenarioBuilder b;
+    int mismatches = 0;
+    double total_secs = 0.0;
+    uint64_t total_positions = 0, total_generated = 0;
+
+    std::printf("%-14s %5s %14s %12s %9s %12s %12s\n",
+                "position", "depth", "nodes", "positions", "seconds", "pos/s", "nodes/s");
+    for(const PerftPosition& p : CORPUS)
+    {
+        if(only && std::strcmp(only, p.name) != 0)
+            continue;
+
+        for(int depth = 1; depth <= max_depth; ++depth)
+        {
+            b.ResetPreRoll(p.player, p.board);
+            b.SetTurnNumbers(p.white_turns, p.black_turns);
+
+            Perft perft(b, depth);
+            auto t0 = std::chrono::steady_clock::now();
+            uint64_t nodes = perft.Run(depth);
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+            total_secs += secs;
+            total_positions += perft.positions;
+            total_generated += perft.generated;
+
+            bool bad = depth <= 2 && nodes != p.expected[depth - 1];
+            mismatches += bad;
+            std::printf("%-14s %5d %14llu %12llu %9.3f %12.0f %12.0f%s\n", p.name, depth,
+                        static_cast<unsigned long long>(nodes), static_cast<unsigned long long>(perft.positions),
+                        secs, perft.positions / secs, perft.generated / secs,
+                        bad ? "  MISMATCH" : "");
+            if(bad)
+                std::printf("%-14s expected %llu\n", "", static_cast<unsigned long long>(p.expected[depth - 1]));
+        }
+    }
+
+    if(total_secs > 0.0)
+        std::printf("total: %llu positions, %llu nodes generated, %.3fs (%.0f pos/s, %.0f nodes/s)\n",
+                    static_cast<unsigned long long>(total_positions), static_cast<unsigned long long>(total_generated),
+                    total_secs, total_positions / total_secs, total_generated / total_secs);
+
+    if(mismatches == 0)
+        std::printf("PERFT OK\n");
+    else
+        std::printf("%d PERFT COUNT(S) DIFFER\n", mismatches);
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# Build and run the movegen perft / throughput benchmark (perft.cpp) against the
+# engine core alone: no pybind11 / Python, no SFML, no model.
+# Usage: perft.sh [max_depth] [position_name]
+set -euo pipefail
+
+HERE="$(cd "$(dirname "$0")" && pwd)"
+CE="$(cd "$HERE/../../../CoreEngine" && pwd)"   # CoreEngine/
+BIN="${TMPDIR:-/tmp}/nardi_perft"
+
+echo "[1/2] compiling perft (engine core only) ..."
+clang++ -std=c++23 -O2 -Wall -mmacosx-version-min=10.15 \
+    "$HERE/perft.cpp" \
+    "$CE/Auxilaries.cpp" \
+    "$CE/Board.cpp" \
+    "$CE/Controller.cpp" \
+    "$CE/Game.cpp" \
+    "$CE/Monitors.cpp" \
+    "$CE/ReaderWriter.cpp" \
+    "$CE/TerminalRW.cpp" \
+    "$CE/ScenarioBuilder.cpp" \
+    -o "$BIN"
+
+echo "[2/2] running ..."
+"$BIN" "$@"
@@ -45,6 +45,18 @@ int play(NardiHandle* h, NardiStrategy white, NardiStrategy black)
             int n = nardi_legal_move_count(h);
             check(n > 0, "human options available");
             check(nardi_apply_human_move(h, 0) == NARDI_OK, "apply_human_move");
+
+            // each recorded sub-move's packed form names the same start square
+            for(int k = 0, n_moves = nardi_move_count(h); k < n_moves; ++k)
+            {
+                int mv[4];
+                unsigned short packed = 0;
+                check(nardi_get_move(h, k, mv) == NARDI_OK, "get_move");
+                check(nardi_get_packed_move(h, k, &packed) == NARDI_OK, "get_packed_move");
+                int idx = packed & 0x1F, player = (packed >> 7) & 1;
+                int row = idx < 12 ? player : !player;
+                check(mv[0] == row && mv[1] == idx % 12, "packed move decodes to its start square");
+            }
         }
     }
     return -1;
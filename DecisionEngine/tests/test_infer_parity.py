@@ -2,6 +2,14 @@
 nardi.InferenceNet) must match the PyTorch models in nardi_net.py to within
 float tolerance.
 
+The comparison runs on the portable reference kernels
+(nardi.set_infer_kernels("reference")); the SIMD kernels picked at runtime are
+then checked against the reference, which they match up to FMA rounding.
+Quantized exports (int8 weights) are checked separately against torch with the
+looser QUANT_* tolerances. evaluate_siblings, which updates the first layer from
+a parent position instead of recomputing it, is checked against evaluate_batch
+on each rolled position's afterstates.
+
 This guards against architecture drift between training (PyTorch) and the
 torch-free C++ inference shipped to other platforms. Run directly
 
@@ -21,7 +29,8 @@ import torch
 sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
 
 import nardi  # noqa: E402
-from nardi_net import NardiNet, ConvNardiNet, ResNardiNet, export_weights  # noqa: E402
+from nardi_net import (NardiNet, ConvNardiNet, ResNardiNet, export_weights,  # noqa: E402
+                       sample_positions)
 
 WEIGHTS_DIR = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), "weights")
 
@@ -42,8 +51,19 @@ ARCH_FOR_FILE = {
     "res_lookahead.pt": lambda: ResNardiNet(),
 }
 
+# positions per sampled Features set
+N_POSITIONS = 1500
+
 ATOL = 1e-4
 RTOL = 1e-4
+SIMD_ATOL = 1e-5
+# int8 weights: mean and worst-case value error vs the float torch model
+QUANT_MEAN_ATOL = 0.02
+QUANT_MAX_ATOL = 0.3
+# evaluate_siblings vs evaluate_batch: float rounding in the first layer, which
+# an int8 net's next layer can round up to one quantization step
+SIBLING_ATOL = 1e-5
+QUANT_SIBLING_ATOL = 2e-3
 
 
 def _load_model(factory, weight_file):
@@ -54,35 +74,37 @@ def _load_model(factory, weight_file):
     return model
 
 
-def _collect_positions(n_positions=1500, seed=0):
-    """Build a diverse Features set: random midgame play (the common case) mixed
-    with random endgame scenarios (high stacks, large pieces_off / pip_count /
-    pieces_not_reached, saturated occupancy planes) so the per-row scalars and
-    the third occupancy plane are exercised near their range."""
-    import random
-    random.seed(seed)
-    np.random.seed(seed)
-
+def _collect_sibling_groups(n_groups=300):
+    """(parent, afterstates) pairs from random play: the pre-roll position and
+    its afterstates for the roll, all featured for the mover."""
     eng = nardi.Engine()
     eng.reset()
-    features = []
-    steps = 0
-    while len(features) < n_positions:
-        # ~ every 25 steps, jump to a fresh random endgame position
-        if steps % 25 == 0:
-            eng.config().withRandomEndgame(bool(steps % 2))
-        elif not eng.should_continue_game():
+    groups = []
+    while len(groups) < n_groups:
+        if not eng.should_continue_game():
             eng.reset()
-
+        parent = eng.board_features()
         options = eng.roll_and_enumerate()
-        features.append(eng.board_features())
-        features.extend(options)
         if options:
-            eng.apply_random_board()   # whole-board apply auto-confirms the turn
+            groups.append((parent, options))
+            eng.apply_random_board()
         else:
-            eng.confirm_turn()         # no moves: pass to the next player
-        steps += 1
-    return features[:n_positions]
+            eng.confirm_turn()
+    return groups
+
+
+def _compare_siblings(blob_path, groups, atol):
+    """Assert evaluate_siblings matches evaluate_batch on every group; return
+    the largest difference."""
+    net = nardi.InferenceNet(blob_path)
+    worst = 0.0
+    for parent, options in groups:
+        batch = np.asarray(net.evaluate_batch(options), dtype=np.float64)
+        siblings = np.asarray(net.evaluate_siblings(parent, options), dtype=np.float64)
+        np.testing.assert_allclose(siblings, batch, atol=atol, rtol=0,
+                                   err_msg="evaluate_siblings drifts from evaluate_batch")
+        worst = max(worst, float(np.abs(siblings - batch).max()))
+    return worst
 
 
 def _compare(model, features):
@@ -92,7 +114,12 @@ def _compare(model, features):
         blob_path = tmp.name
     try:
         export_weights(model, blob_path)
-        cpp_net = nardi.InferenceNet(blob_path)
+        nardi.set_infer_kernels("reference")
+        try:
+            cpp_net = nardi.InferenceNet(blob_path)
+        finally:
+            nardi.set_infer_kernels("auto")
+        simd_net = nardi.InferenceNet(blob_path)
 
         with torch.inference_mode():
             torch_vals = model(features).detach().cpu().numpy().astype(np.float64)
@@ -102,19 +129,49 @@ def _compare(model, features):
         # single vs batch must be bit-identical (same code path per row)
         np.testing.assert_array_equal(cpp_single, cpp_batch)
 
+        # the runtime-selected SIMD kernels track the reference
+        simd_batch = np.asarray(simd_net.evaluate_batch(features), dtype=np.float64)
+        simd_single = np.asarray([simd_net.evaluate(f) for f in features], dtype=np.float64)
+        np.testing.assert_array_equal(simd_single, simd_batch)
+        np.testing.assert_allclose(simd_batch, cpp_batch, atol=SIMD_ATOL, rtol=0,
+                                   err_msg=f"{nardi.infer_kernels()} kernels drift from reference")
+
         diff = np.abs(torch_vals - cpp_batch)
         return diff.max(), torch_vals, cpp_batch
     finally:
         os.remove(blob_path)
 
 
+def _compare_quantized(model, calibration, features):
+    """Return (mean, max) abs diff between torch and the int8 C++ net, and assert
+    the quantized single-position path matches its batch path."""
+    with tempfile.NamedTemporaryFile(suffix=".nardiw", delete=False) as tmp:
+        blob_path = tmp.name
+    try:
+        export_weights(model, blob_path, quantize=True, calibration=calibration)
+        cpp_net = nardi.InferenceNet(blob_path)
+        with torch.inference_mode():
+            torch_vals = model(features).detach().cpu().numpy().astype(np.float64)
+        cpp_batch = np.asarray(cpp_net.evaluate_batch(features), dtype=np.float64)
+        cpp_single = np.asarray([cpp_net.evaluate(f) for f in features], dtype=np.float64)
+        np.testing.assert_array_equal(cpp_single, cpp_batch)
+        diff = np.abs(torch_vals - cpp_batch)
+        return diff.mean(), diff.max()
+    finally:
+        os.remove(blob_path)
+
+
 def _all_weight_files():
     return sorted(os.path.basename(p) for p in glob.glob(os.path.join(WEIGHTS_DIR, "*.pt")))
 
 
+def _mapped_weight_files():
+    return [f for f in _all_weight_files() if f in ARCH_FOR_FILE]
+
+
 def test_inference_parity():
-    # multiple seeds -> different random position distributions
-    feature_sets = [_collect_positions(seed=s) for s in (0, 1)]
+    # two independent samples -> different random position distributions
+    feature_sets = [sample_positions(N_POSITIONS) for _ in range(2)]
     for weight_file in _all_weight_files():
         factory = ARCH_FOR_FILE.get(weight_file)
         assert factory is not None, (
@@ -127,11 +184,37 @@ def test_inference_parity():
                                        err_msg=f"{weight_file}: C++/torch mismatch")
 
 
+def test_quantized_parity():
+    # calibrate on one position set, measure on the other
+    calibration, features = (sample_positions(N_POSITIONS) for _ in range(2))
+    for weight_file in _mapped_weight_files():
+        model = _load_model(ARCH_FOR_FILE[weight_file], weight_file)
+        mean, worst = _compare_quantized(model, calibration, features)
+        assert mean <= QUANT_MEAN_ATOL, f"{weight_file}: int8 mean |diff| {mean:.4f}"
+        assert worst <= QUANT_MAX_ATOL, f"{weight_file}: int8 max |diff| {worst:.4f}"
+
+
+def test_sibling_parity():
+    calibration = sample_positions(N_POSITIONS)
+    groups = _collect_sibling_groups()
+    for weight_file in _mapped_weight_files():
+        model = _load_model(ARCH_FOR_FILE[weight_file], weight_file)
+        with tempfile.NamedTemporaryFile(suffix=".nardiw", delete=False) as tmp:
+            blob_path = tmp.name
+        try:
+            export_weights(model, blob_path)
+            _compare_siblings(blob_path, groups, SIBLING_ATOL)
+            export_weights(model, blob_path, quantize=True, calibration=calibration)
+            _compare_siblings(blob_path, groups, QUANT_SIBLING_ATOL)
+        finally:
+            os.remove(blob_path)
+
+
 if __name__ == "__main__":
-    feature_sets = [_collect_positions(seed=s) for s in (0, 1)]
+    feature_sets = [sample_positions(N_POSITIONS) for _ in range(2)]
     n_pos = sum(len(f) for f in feature_sets)
     print(f"Comparing all weights over {n_pos} positions "
-          f"(midgame+endgame, atol={ATOL}, rtol={RTOL}):")
+          f"(midgame+endgame, atol={ATOL}, rtol={RTOL}; SIMD kernels: {nardi.infer_kernels()}):")
     known = set(ARCH_FOR_FILE)
     found = set(_all_weight_files())
     for extra in sorted(found - known):
@@ -155,5 +238,27 @@ if __name__ == "__main__":
         except Exception as exc:  # noqa: BLE001
             failures += 1
             print(f"  [FAIL] {weight_file:38s} {type(exc).__name__}: {exc}")
+
+    print(f"Quantized (int8) exports, calibrated on one sample, measured on another "
+          f"(mean<={QUANT_MEAN_ATOL}, max<={QUANT_MAX_ATOL}):")
+    for weight_file in _mapped_weight_files():
+        try:
+            model = _load_model(ARCH_FOR_FILE[weight_file], weight_file)
+            mean, worst = _compare_quantized(model, feature_sets[0], feature_sets[1])
+            ok = mean <= QUANT_MEAN_ATOL and worst <= QUANT_MAX_ATOL
+            print(f"  [{'OK' if ok else 'FAIL':4s}] {weight_file:38s} mean|diff| = {mean:.2e}  max|diff| = {worst:.2e}")
+            failures += not ok
+        except Exception as exc:  # noqa: BLE001
+            failures += 1
+            print(f"  [FAIL] {weight_file:38s} {type(exc).__name__}: {exc}")
+
+    print(f"evaluate_siblings vs evaluate_batch on rolled afterstates "
+          f"(atol={SIBLING_ATOL}, int8 atol={QUANT_SIBLING_ATOL}):")
+    try:
+        test_sibling_parity()
+        print("  [OK]")
+    except Exception as exc:  # noqa: BLE001
+        failures += 1
+        print(f"  [FAIL] {type(exc).__name__}: {exc}")
     print("ALL PASSED" if not failures else f"{failures} FAILURE(S)")
     sys.exit(1 if failures else 0)
@@ -7,6 +7,10 @@ training-target:
     one-ply expansion even for a single legal move, because train.py bootstraps
     the value target from those replies (that's value estimation, not move
     choice). This test asserts the target builder is NOT short-circuited.
+  * Grandchild leaves shared between children / dice are stored once: every
+    eval board is unique and num_leaves counts the references before dedup.
+  * tensor_out / feature_batch_to_tensor_out fill a reused buffer with exactly
+    what tensor / feature_batch_to_tensor return.
 
 Run directly:  python tests/test_lookahead_target.py
 """
@@ -62,6 +66,65 @@ def test_training_lookahead_not_shortcircuited():
           f"(training lookahead targets intact)")
 
 
+def test_lookahead_leaves_deduplicated():
+    eng = nardi.Engine()
+    eng.reset()
+    ratios = []
+    for _ in range(40):
+        if not eng.should_continue_game():
+            eng.reset()
+        children = eng.roll_and_enumerate()
+        if len(children) == 0:
+            eng.confirm_turn()
+            continue
+        batch = eng.make_lookahead_batch()
+        boards = {np.asarray(f.raw_data, dtype=np.int8).tobytes() for f in batch.eval_features}
+        assert len(boards) == batch.num_eval_features, "eval positions must be unique"
+        assert batch.num_leaves >= batch.num_eval_features
+        if batch.num_eval_features > 0:
+            ratios.append(batch.dedup_ratio)
+        eng.apply_random_board()
+
+    assert ratios and max(ratios) > 1.0, "expected shared grandchildren somewhere"
+    print(f"lookahead dedup ratio: mean {np.mean(ratios):.2f}, max {max(ratios):.2f}")
+
+
+def test_tensor_out_matches_tensor():
+    eng = nardi.Engine()
+    eng.reset()
+    eng.set_and_enumerate(3, 5)
+    batch = eng.make_lookahead_batch()
+    n = batch.num_eval_features
+
+    for kind, flatten in (("conv", False), ("legacy", True)):
+        ref = batch.tensor(kind, flatten)
+        buf = np.full((n + 7,) + ref.shape[1:], np.nan, dtype=np.float32)
+        assert batch.tensor_out(buf, kind) == n
+        assert np.array_equal(buf[:n], ref) and np.isnan(buf[n:]).all()
+
+        # chunked fill through a smaller buffer
+        small = np.empty((64,) + ref.shape[1:], dtype=np.float32)
+        start = 0
+        while start < n:
+            rows = batch.tensor_out(small, kind, start)
+            assert np.array_equal(small[:rows], ref[start:start + rows])
+            start += rows
+
+    feats = batch.eval_features[:10]
+    out = np.empty((10, 6, 25), dtype=np.float32)
+    assert nardi.feature_batch_to_tensor_out(feats, out) == 10
+    assert np.array_equal(out, nardi.feature_batch_to_tensor(feats))
+
+    for bad in (np.empty((10, 150), dtype=np.float64), np.empty((10, 6, 50), dtype=np.float32)[:, :, ::2]):
+        try:
+            nardi.feature_batch_to_tensor_out(feats, bad)
+        except RuntimeError:
+            continue
+        raise AssertionError("non-float32 / non-contiguous buffer must be rejected")
+
+
 if __name__ == "__main__":
     test_training_lookahead_not_shortcircuited()
+    test_lookahead_leaves_deduplicated()
+    test_tensor_out_matches_tensor()
     print("LOOKAHEAD TARGET OK")
@@ -5,7 +5,8 @@ animation:
     them on the pre-move board reproduces the post-move board;
   * a checker played with both dice is recorded as two chained hops
     (move[1].from == move[0].to) -- i.e. the intermediate landing is captured;
-  * a single incremental human move records exactly one sub-move.
+  * a single incremental human move records exactly one sub-move;
+  * the 16-bit packed log (recent_moves_packed) decodes to the same sub-moves.
 
 Run directly:  python tests/test_move_log.py
 """
@@ -75,6 +76,39 @@ def test_whole_board_submoves_reproduce_transition():
           f"{chained} had chained two-hop moves")
 
 
+def unpack(bits):
+    """Decode a recent_moves_packed entry to [fromRow, fromCol, toRow, toCol]."""
+    idx, bear_off, player, die = bits & 0x1F, bits >> 6 & 1, bits >> 7 & 1, bits >> 8 & 0x7
+    undone = bits >> 15 & 1
+
+    def square(i):
+        return [player if i < COLS else 1 - player, i % COLS]
+
+    start = square(idx)
+    end = [-1, -1] if bear_off else square(idx + die)
+    return end + start if undone else start + end
+
+
+def test_packed_log_matches_coordinates():
+    eng = nardi.Engine()
+    eng.reset()
+    checked = 0
+    for _ in range(150):
+        if not eng.should_continue_game():
+            eng.reset()
+        if not eng.roll_and_enumerate():
+            eng.confirm_turn()
+            continue
+        eng.apply_random_board()
+        moves = [list(m) for m in eng.recent_moves()]
+        packed = eng.recent_moves_packed()
+        assert len(packed) == len(moves)
+        assert [unpack(b) for b in packed] == moves, "packed log must decode to recent_moves"
+        checked += len(moves)
+    assert checked > 0
+    print(f"verified {checked} packed sub-moves against their coordinates")
+
+
 def test_single_human_move_is_one_submove():
     eng = nardi.Engine()
     eng.configure_players(nardi.Strategy.Human, nardi.Strategy.Human)
@@ -113,5 +147,6 @@ def test_single_human_move_is_one_submove():
 
 if __name__ == "__main__":
     test_whole_board_submoves_reproduce_transition()
+    test_packed_log_matches_coordinates()
     test_single_human_move_is_one_submove()
     print("MOVE LOG OK")